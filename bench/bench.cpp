@@ -0,0 +1,834 @@
+/*
+ * Benchmark suite for darr.
+ *
+ * Every operation is measured for darr, std::vector and hand-written C code
+ * that manages its own buffer with realloc. Results are written to standard
+ * output as JSON so that they can be stored and compared between versions.
+ * The heap benchmark instead compares darr heaps of arity 2, 4 and 8 with a
+ * binary heap kept in a std::vector. The shift benchmarks also measure darr
+ * with every move made by darr_data_move_stream and darr_parallel_data_move.
+ * The fifo benchmark compares a queue kept in a darr with a darr_ring.
+ *
+ * Usage: bench [--max-size N] [--min-time SECONDS] [--filter TEXT]
+ *
+ * Sizes start at 16 elements and are multiplied by 4 until they exceed
+ * --max-size, which defaults to 1048576 and may be set as high as 1073741824.
+ * Elements are ints.
+ *
+ * For every measurement the following is reported:
+ * - ns_per_op: wall clock time per operation.
+ * - bytes_per_op: bytes requested from the allocator per operation.
+ * - allocs_per_op: calls to the allocator per operation.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <darr.h>
+#include <darr_heap.h>
+#include <darr_parallel.h>
+#include <darr_ring.h>
+
+typedef int element;
+
+/*
+ * Allocation counters. Every implementation allocates through these.
+ */
+static size_t bench_allocs;
+static size_t bench_bytes;
+
+static void *bench_realloc(void *p, size_t size)
+{
+	bench_allocs += 1;
+	bench_bytes += size;
+	return realloc(p, size);
+}
+
+template<typename T>
+struct bench_allocator {
+	typedef T value_type;
+
+	bench_allocator() {}
+
+	template<typename U>
+	bench_allocator(const bench_allocator<U> &) {}
+
+	T *allocate(size_t n)
+	{
+		bench_allocs += 1;
+		bench_bytes += n * sizeof(T);
+		return static_cast<T *>(malloc(n * sizeof(T)));
+	}
+
+	void deallocate(T *p, size_t)
+	{
+		free(p);
+	}
+};
+
+template<typename T, typename U>
+bool operator==(const bench_allocator<T> &, const bench_allocator<U> &)
+{
+	return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const bench_allocator<T> &, const bench_allocator<U> &)
+{
+	return false;
+}
+
+typedef std::vector<element, bench_allocator<element> > vector;
+
+/*
+ * Hand-written C array that doubles its capacity with realloc.
+ */
+struct raw {
+	element *data;
+	size_t size;
+	size_t capacity;
+};
+
+static void raw_init(struct raw *r)
+{
+	r->data = NULL;
+	r->size = 0;
+	r->capacity = 0;
+}
+
+static void raw_deinit(struct raw *r)
+{
+	free(r->data);
+}
+
+static int raw_reserve(struct raw *r, size_t capacity)
+{
+	if (capacity <= r->capacity) {
+		return 1;
+	}
+
+	size_t new_capacity = r->capacity ? r->capacity : 1;
+
+	while (new_capacity < capacity) {
+		new_capacity *= 2;
+	}
+
+	element *data = static_cast<element *>(
+		bench_realloc(r->data, new_capacity * sizeof(element)));
+
+	if (data == NULL) {
+		return 0;
+	}
+
+	r->data = data;
+	r->capacity = new_capacity;
+	return 1;
+}
+
+static int raw_resize(struct raw *r, size_t size)
+{
+	if (!raw_reserve(r, size)) {
+		return 0;
+	}
+
+	r->size = size;
+	return 1;
+}
+
+/*
+ * Keeps the compiler from discarding work whose result is never used.
+ */
+static volatile element sink;
+
+static void escape(const void *p)
+{
+	asm volatile("" : : "g"(p) : "memory");
+}
+
+/*
+ * Number of insertions and removals done per run of the insert and remove
+ * benchmarks. They are paired so that the size of the array stays at n.
+ */
+static const size_t batch = 64;
+
+/*
+ * State shared by the setup, run and teardown functions of a benchmark.
+ */
+static struct darr darr_a;
+static struct darr darr_b;
+static vector vector_a;
+static vector vector_b;
+static struct raw raw_a;
+static struct raw raw_b;
+
+static void fill(element *p, size_t n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		p[i] = (element) i;
+	}
+}
+
+static void setup_darr(size_t n)
+{
+	darr_init(&darr_a, sizeof(element));
+	darr_resize(&darr_a, n);
+	fill(static_cast<element *>(darr_data(&darr_a)), n);
+	darr_init(&darr_b, sizeof(element));
+}
+
+static void teardown_darr()
+{
+	darr_deinit(&darr_a);
+	darr_deinit(&darr_b);
+}
+
+static void setup_vector(size_t n)
+{
+	vector_a.assign(n, 0);
+	fill(vector_a.data(), n);
+	vector_b.clear();
+}
+
+static void teardown_vector()
+{
+	vector().swap(vector_a);
+	vector().swap(vector_b);
+}
+
+static void setup_raw(size_t n)
+{
+	raw_init(&raw_a);
+	raw_resize(&raw_a, n);
+	fill(raw_a.data, n);
+	raw_init(&raw_b);
+}
+
+static void teardown_raw()
+{
+	raw_deinit(&raw_a);
+	raw_deinit(&raw_b);
+}
+
+static void setup_empty_darr(size_t)
+{
+	setup_darr(0);
+}
+
+static void setup_empty_vector(size_t)
+{
+	setup_vector(0);
+}
+
+static void setup_empty_raw(size_t)
+{
+	setup_raw(0);
+}
+
+/*
+ * Push: appends n elements one at a time to an empty array.
+ */
+static size_t push_darr(size_t n)
+{
+	struct darr d;
+	darr_init(&d, sizeof(element));
+
+	for (size_t i = 0; i < n; ++i) {
+		darr_grow(&d, 1);
+		*static_cast<element *>(darr_last(&d)) = (element) i;
+	}
+
+	sink = *static_cast<element *>(darr_last(&d));
+	darr_deinit(&d);
+	return n;
+}
+
+static size_t push_vector(size_t n)
+{
+	vector v;
+
+	for (size_t i = 0; i < n; ++i) {
+		v.push_back((element) i);
+	}
+
+	escape(v.data());
+	return n;
+}
+
+static size_t push_raw(size_t n)
+{
+	struct raw r;
+	raw_init(&r);
+
+	for (size_t i = 0; i < n; ++i) {
+		raw_resize(&r, r.size + 1);
+		r.data[r.size - 1] = (element) i;
+	}
+
+	sink = r.data[r.size - 1];
+	raw_deinit(&r);
+	return n;
+}
+
+/*
+ * Resize: grows an empty array to n elements by doubling its size.
+ */
+static size_t resize_darr(size_t n)
+{
+	size_t ops = 0;
+	struct darr d;
+	darr_init(&d, sizeof(element));
+
+	for (size_t s = 1; s <= n; s *= 2, ++ops) {
+		darr_resize(&d, s);
+		*static_cast<element *>(darr_last(&d)) = (element) s;
+	}
+
+	sink = *static_cast<element *>(darr_last(&d));
+	darr_deinit(&d);
+	return ops;
+}
+
+static size_t resize_vector(size_t n)
+{
+	size_t ops = 0;
+	vector v;
+
+	for (size_t s = 1; s <= n; s *= 2, ++ops) {
+		v.resize(s);
+		v.back() = (element) s;
+	}
+
+	escape(v.data());
+	return ops;
+}
+
+static size_t resize_raw(size_t n)
+{
+	size_t ops = 0;
+	struct raw r;
+	raw_init(&r);
+
+	for (size_t s = 1; s <= n; s *= 2, ++ops) {
+		raw_resize(&r, s);
+		r.data[s - 1] = (element) s;
+	}
+
+	sink = r.data[r.size - 1];
+	raw_deinit(&r);
+	return ops;
+}
+
+/*
+ * Insert and remove: inserts a batch of elements one at a time at a
+ * position relative to the size of the array and then removes them again.
+ */
+static size_t position(size_t size, int where)
+{
+	switch (where) {
+	case 0:
+		return 0;
+	case 1:
+		return size / 2;
+	default:
+		return size;
+	}
+}
+
+template<int where>
+static size_t insert_darr(size_t)
+{
+	element e = 1;
+	struct darr_view v = { sizeof(element), 1, (const char *) &e };
+
+	for (size_t i = 0; i < batch; ++i) {
+		darr_insert_view(&darr_a, position(darr_size(&darr_a), where), v);
+	}
+
+	for (size_t i = 0; i < batch; ++i) {
+		darr_remove(&darr_a, position(darr_size(&darr_a) - 1, where), 1);
+	}
+
+	return batch * 2;
+}
+
+template<int where>
+static size_t insert_vector(size_t)
+{
+	for (size_t i = 0; i < batch; ++i) {
+		vector_a.insert(
+			vector_a.begin() + position(vector_a.size(), where),
+			1);
+	}
+
+	for (size_t i = 0; i < batch; ++i) {
+		vector_a.erase(
+			vector_a.begin() + position(vector_a.size() - 1, where));
+	}
+
+	return batch * 2;
+}
+
+template<int where>
+static size_t insert_raw(size_t)
+{
+	for (size_t i = 0; i < batch; ++i) {
+		size_t p = position(raw_a.size, where);
+		raw_resize(&raw_a, raw_a.size + 1);
+		memmove(
+			raw_a.data + p + 1,
+			raw_a.data + p,
+			(raw_a.size - p - 1) * sizeof(element));
+		raw_a.data[p] = 1;
+	}
+
+	for (size_t i = 0; i < batch; ++i) {
+		size_t p = position(raw_a.size - 1, where);
+		memmove(
+			raw_a.data + p,
+			raw_a.data + p + 1,
+			(raw_a.size - p - 1) * sizeof(element));
+		raw_a.size -= 1;
+	}
+
+	return batch * 2;
+}
+
+/*
+ * Shift: moves all elements one step to the right and back to the left.
+ */
+static size_t shift_darr(size_t)
+{
+	darr_shift_right(&darr_a, 1);
+	darr_shift_left(&darr_a, 1);
+	return 2;
+}
+
+static size_t shift_vector(size_t)
+{
+	std::copy_backward(vector_a.begin(), vector_a.end() - 1, vector_a.end());
+	std::copy(vector_a.begin() + 1, vector_a.end(), vector_a.begin());
+	return 2;
+}
+
+static size_t shift_raw(size_t)
+{
+	memmove(raw_a.data + 1, raw_a.data, (raw_a.size - 1) * sizeof(element));
+	memmove(raw_a.data, raw_a.data + 1, (raw_a.size - 1) * sizeof(element));
+	return 2;
+}
+
+/*
+ * Shift far: moves the first half of the array over the second half and the
+ * second half back over the first.
+ */
+static size_t shift_far_darr(size_t n)
+{
+	darr_shift_right(&darr_a, n / 2);
+	darr_shift_left(&darr_a, n / 2);
+	return 2;
+}
+
+static size_t shift_far_raw(size_t n)
+{
+	size_t half = n / 2;
+
+	memmove(raw_a.data + half, raw_a.data, (n - half) * sizeof(element));
+	memmove(raw_a.data, raw_a.data + half, (n - half) * sizeof(element));
+	return 2;
+}
+
+/*
+ * Shift and shift far with the large move path forced on for every size, so
+ * that streaming and parallel moves can be compared with memmove against the
+ * number of elements moved.
+ */
+static void setup_darr_stream(size_t n)
+{
+	setup_darr(n);
+	darr_global_data_move_set(0, darr_data_move_stream);
+}
+
+static void setup_darr_parallel(size_t n)
+{
+	setup_darr(n);
+	darr_global_data_move_set(0, darr_parallel_data_move);
+}
+
+static void teardown_darr_large_move()
+{
+	darr_global_data_move_set(DARR_DATA_MOVE_THRESHOLD, darr_data_move_stream);
+	teardown_darr();
+}
+
+/*
+ * Shift slice: like shift but only over the middle half of the array.
+ */
+static size_t shift_slice_darr(size_t n)
+{
+	darr_shift_slice_right(&darr_a, 1, n / 4, n / 2);
+	darr_shift_slice_left(&darr_a, 1, n / 4, n / 2);
+	return 2;
+}
+
+static size_t shift_slice_vector(size_t n)
+{
+	vector::iterator begin = vector_a.begin() + n / 4;
+	vector::iterator end = begin + n / 2;
+
+	std::copy_backward(begin, end - 1, end);
+	std::copy(begin + 1, end, begin);
+	return 2;
+}
+
+static size_t shift_slice_raw(size_t n)
+{
+	element *begin = raw_a.data + n / 4;
+	size_t bytes = (n / 2 - 1) * sizeof(element);
+
+	memmove(begin + 1, begin, bytes);
+	memmove(begin, begin + 1, bytes);
+	return 2;
+}
+
+/*
+ * Copy: creates a copy of an array of n elements and disposes it.
+ */
+static size_t copy_darr(size_t)
+{
+	struct darr d;
+
+	if (darr_copy(&d, &darr_a)) {
+		escape(darr_data(&d));
+		darr_deinit(&d);
+	}
+
+	return 1;
+}
+
+static size_t copy_vector(size_t)
+{
+	vector v(vector_a);
+	escape(v.data());
+	return 1;
+}
+
+static size_t copy_raw(size_t)
+{
+	struct raw r;
+	raw_init(&r);
+	raw_resize(&r, raw_a.size);
+	memcpy(r.data, raw_a.data, raw_a.size * sizeof(element));
+	escape(r.data);
+	raw_deinit(&r);
+	return 1;
+}
+
+/*
+ * Move: moves the elements of an array of n elements to another array and
+ * back.
+ */
+static size_t move_darr(size_t)
+{
+	darr_deinit(&darr_b);
+	darr_move(&darr_b, &darr_a);
+	darr_deinit(&darr_a);
+	darr_move(&darr_a, &darr_b);
+	return 2;
+}
+
+static size_t move_vector(size_t)
+{
+	vector_b = std::move(vector_a);
+	vector_a = std::move(vector_b);
+	return 2;
+}
+
+static size_t move_raw(size_t)
+{
+	raw_b = raw_a;
+	raw_init(&raw_a);
+	raw_a = raw_b;
+	raw_init(&raw_b);
+	return 2;
+}
+
+/*
+ * Append: appends an array of n elements to an empty array.
+ */
+static size_t append_darr(size_t)
+{
+	darr_append(&darr_b, &darr_a);
+	escape(darr_data(&darr_b));
+	darr_resize(&darr_b, 0);
+	return 1;
+}
+
+static size_t append_vector(size_t)
+{
+	vector v;
+	v.insert(v.end(), vector_a.begin(), vector_a.end());
+	escape(v.data());
+	return 1;
+}
+
+static size_t append_raw(size_t)
+{
+	raw_resize(&raw_b, raw_a.size);
+	memcpy(raw_b.data, raw_a.data, raw_a.size * sizeof(element));
+	escape(raw_b.data);
+	raw_deinit(&raw_b);
+	raw_init(&raw_b);
+	return 1;
+}
+
+/*
+ * Heap: pops the first element of a heap of n elements and pushes a random
+ * one, a batch of times. std::vector is used as a binary heap through
+ * std::push_heap and std::pop_heap. Heap replace does the same with
+ * darr_heap_replace, which sifts once and keeps the size of the array.
+ */
+static unsigned heap_random;
+
+static element heap_next()
+{
+	heap_random = heap_random * 1103515245 + 12345;
+	return (element) (heap_random >> 8);
+}
+
+static int heap_compare(const void *a, const void *b)
+{
+	element x = *static_cast<const element *>(a);
+	element y = *static_cast<const element *>(b);
+	return (x > y) - (x < y);
+}
+
+template<size_t arity>
+static size_t heap_darr(size_t)
+{
+	for (size_t i = 0; i < batch; ++i) {
+		element e = heap_next();
+		darr_heap_pop(&darr_a, arity, heap_compare, NULL);
+		darr_heap_push(&darr_a, arity, heap_compare, &e);
+	}
+
+	escape(darr_data(&darr_a));
+	return batch * 2;
+}
+
+template<size_t arity>
+static size_t heap_replace_darr(size_t)
+{
+	for (size_t i = 0; i < batch; ++i) {
+		element e = heap_next();
+		darr_heap_replace(&darr_a, arity, heap_compare, &e, NULL);
+	}
+
+	escape(darr_data(&darr_a));
+	return batch * 2;
+}
+
+static size_t heap_vector(size_t)
+{
+	for (size_t i = 0; i < batch; ++i) {
+		std::pop_heap(
+			vector_a.begin(),
+			vector_a.end(),
+			std::greater<element>());
+		vector_a.back() = heap_next();
+		std::push_heap(
+			vector_a.begin(),
+			vector_a.end(),
+			std::greater<element>());
+	}
+
+	escape(vector_a.data());
+	return batch * 2;
+}
+
+/*
+ * FIFO: adds a batch of elements to the back of a queue of n elements and
+ * takes a batch from the front. A queue kept in a darr moves every element
+ * left down when elements are taken out, darr_ring only copies the batches.
+ */
+static struct darr_ring ring_a;
+static element fifo_batch[batch];
+
+static void setup_ring(size_t n)
+{
+	setup_darr(n);
+	darr_ring_init(&ring_a, sizeof(element), n + batch);
+	darr_ring_push(&ring_a, darr_data(&darr_a), n);
+}
+
+static void teardown_ring()
+{
+	darr_ring_deinit(&ring_a);
+	teardown_darr();
+}
+
+static size_t fifo_darr(size_t)
+{
+	size_t size = darr_size(&darr_a);
+	darr_grow(&darr_a, batch);
+	memcpy(darr_element(&darr_a, size), fifo_batch, sizeof(fifo_batch));
+	memcpy(fifo_batch, darr_data(&darr_a), sizeof(fifo_batch));
+	darr_remove(&darr_a, 0, batch);
+	escape(fifo_batch);
+	return batch * 2;
+}
+
+static size_t fifo_ring(size_t)
+{
+	darr_ring_push(&ring_a, fifo_batch, batch);
+	darr_ring_pop(&ring_a, fifo_batch, batch);
+	escape(fifo_batch);
+	return batch * 2;
+}
+
+struct benchmark {
+	const char *name;
+	const char *impl;
+	void (*setup)(size_t n);
+	size_t (*run)(size_t n);
+	void (*teardown)();
+};
+
+#define BENCH_ALL(name, setup) \
+	{ #name, "darr", setup##_darr, name##_darr, teardown_darr }, \
+	{ #name, "vector", setup##_vector, name##_vector, teardown_vector }, \
+	{ #name, "raw", setup##_raw, name##_raw, teardown_raw }
+
+#define BENCH_ALL_AT(name, where) \
+	{ #name, "darr", setup_darr, insert_darr<where>, teardown_darr }, \
+	{ #name, "vector", setup_vector, insert_vector<where>, teardown_vector }, \
+	{ #name, "raw", setup_raw, insert_raw<where>, teardown_raw }
+
+static const struct benchmark benchmarks[] = {
+	BENCH_ALL(push, setup_empty),
+	BENCH_ALL(resize, setup_empty),
+	BENCH_ALL_AT(insert_remove_front, 0),
+	BENCH_ALL_AT(insert_remove_middle, 1),
+	BENCH_ALL_AT(insert_remove_back, 2),
+	BENCH_ALL(shift, setup),
+	{ "shift", "darr-stream", setup_darr_stream, shift_darr,
+		teardown_darr_large_move },
+	{ "shift_far", "darr", setup_darr, shift_far_darr, teardown_darr },
+	{ "shift_far", "darr-stream", setup_darr_stream, shift_far_darr,
+		teardown_darr_large_move },
+	{ "shift_far", "darr-parallel", setup_darr_parallel, shift_far_darr,
+		teardown_darr_large_move },
+	{ "shift_far", "raw", setup_raw, shift_far_raw, teardown_raw },
+	BENCH_ALL(shift_slice, setup),
+	BENCH_ALL(copy, setup),
+	BENCH_ALL(move, setup),
+	BENCH_ALL(append, setup),
+	{ "heap", "darr-2", setup_darr, heap_darr<2>, teardown_darr },
+	{ "heap", "darr-4", setup_darr, heap_darr<4>, teardown_darr },
+	{ "heap", "darr-8", setup_darr, heap_darr<8>, teardown_darr },
+	{ "heap", "vector", setup_vector, heap_vector, teardown_vector },
+	{ "heap_replace", "darr-2", setup_darr, heap_replace_darr<2>,
+		teardown_darr },
+	{ "heap_replace", "darr-4", setup_darr, heap_replace_darr<4>,
+		teardown_darr },
+	{ "heap_replace", "darr-8", setup_darr, heap_replace_darr<8>,
+		teardown_darr },
+	{ "fifo", "darr", setup_darr, fifo_darr, teardown_darr },
+	{ "fifo", "darr-ring", setup_ring, fifo_ring, teardown_ring },
+};
+
+/*
+ * Runs a benchmark repeatedly until at least min_time seconds have passed
+ * and prints the results as a JSON object.
+ */
+static void measure(
+	const struct benchmark *b,
+	size_t n,
+	double min_time,
+	int first)
+{
+	typedef std::chrono::steady_clock clock;
+
+	size_t runs = 0;
+	size_t ops = 0;
+	double elapsed = 0;
+
+	b->setup(n);
+
+	bench_allocs = 0;
+	bench_bytes = 0;
+
+	while (elapsed < min_time) {
+		clock::time_point start = clock::now();
+		ops += b->run(n);
+		clock::time_point end = clock::now();
+
+		elapsed += std::chrono::duration<double>(end - start).count();
+		runs += 1;
+	}
+
+	size_t allocs = bench_allocs;
+	size_t bytes = bench_bytes;
+
+	b->teardown();
+
+	printf("%s\n    {\"name\": \"%s\", \"impl\": \"%s\", \"size\": %zu, "
+		"\"runs\": %zu, \"ns_per_op\": %.3f, \"bytes_per_op\": %.3f, "
+		"\"allocs_per_op\": %.3f}",
+		first ? "" : ",",
+		b->name,
+		b->impl,
+		n,
+		runs,
+		elapsed * 1e9 / ops,
+		(double) bytes / ops,
+		(double) allocs / ops);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t max_size = 1 << 20;
+	double min_time = 0.1;
+	const char *filter = NULL;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+			max_size = strtoull(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+			min_time = strtod(argv[++i], NULL);
+		} else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		} else {
+			fprintf(stderr, "Usage: %s [--max-size N] "
+				"[--min-time SECONDS] [--filter TEXT]\n",
+				argv[0]);
+			return 1;
+		}
+	}
+
+	darr_global_realloc_set(bench_realloc);
+
+	int first = 1;
+
+	printf("{\n  \"benchmarks\": [");
+
+	for (const struct benchmark &b : benchmarks) {
+		if (filter && strstr(b.name, filter) == NULL) {
+			continue;
+		}
+
+		for (size_t n = 16; n <= max_size; n *= 4) {
+			measure(&b, n, min_time, first);
+			first = 0;
+		}
+	}
+
+	printf("\n  ]\n}\n");
+	return 0;
+}
@@ -1,12 +1,214 @@
 #include "darr.h"
+#include "darr_cpu.h"
+
+#ifdef DARR_CPU_X86
+#include <immintrin.h>
+#endif
+
+DARR_GLOBAL darr_realloc_t darr_realloc = realloc;
+
+DARR_GLOBAL darr_free_t darr_free = free;
+
+DARR_GLOBAL darr_calloc_t darr_calloc = calloc;
+
+DARR_GLOBAL size_t darr_data_move_threshold = DARR_DATA_MOVE_THRESHOLD;
+
+DARR_GLOBAL darr_data_move_t darr_data_move_large = darr_data_move_stream;
+
+#ifdef DARR_STATS
+DARR_GLOBAL struct darr_stats darr_stats_global;
+
+static const char *darr_stats_op_names[DARR_STATS_OP_COUNT] = {
+	"copy",
+	"shift",
+	"append",
+	"prepend",
+	"insert",
+};
+
+DARR_API void darr_stats_dump(FILE *stream, const struct darr_stats *s)
+{
+	fprintf(stream, "reallocs: %zu\n", s->reallocs);
+	fprintf(stream, "frees: %zu\n", s->frees);
+	fprintf(stream, "bytes allocated: %zu\n", s->bytes_allocated);
+
+	for (int op = 0; op < DARR_STATS_OP_COUNT; ++op) {
+		fprintf(stream,
+			"%s: %zu memmoves (%zu bytes), "
+			"%zu memcpys (%zu bytes)\n",
+			darr_stats_op_names[op],
+			s->memmoves[op],
+			s->bytes_memmoved[op],
+			s->memcpys[op],
+			s->bytes_memcpyed[op]);
+	}
+}
+
+#ifndef DARR_HEADER_ONLY
+extern inline void darr_stats_reset(struct darr_stats *s);
+
+extern inline const struct darr_stats *darr_stats_get(const struct darr *d);
+
+extern inline struct darr_stats *darr_stats_global_get(void);
+
+extern inline void darr_stats_record_realloc(
+	struct darr_stats *s,
+	size_t bytes);
+
+extern inline void darr_stats_record_free(struct darr_stats *s);
+
+extern inline void darr_stats_record_memmove(
+	struct darr_stats *s,
+	enum darr_stats_op op,
+	size_t bytes);
+
+extern inline void darr_stats_record_memcpy(
+	struct darr_stats *s,
+	enum darr_stats_op op,
+	size_t bytes);
+#endif
+#endif
+
+#ifdef DARR_CACHE
+/*
+ * Cached buffers are kept in singly linked lists. The pointer to the next
+ * buffer is stored at the start of each buffer.
+ */
+struct darr_cache {
+	int initialized;
+	void *head[DARR_CACHE_CLASSES];
+	size_t count[DARR_CACHE_CLASSES];
+	size_t limit[DARR_CACHE_CLASSES];
+	struct darr_cache_stats stats;
+};
+
+static _Thread_local struct darr_cache darr_cache;
+
+static struct darr_cache *darr_cache_get(void)
+{
+	struct darr_cache *c = &darr_cache;
+
+	if (!c->initialized) {
+		for (size_t i = 0; i < 16; ++i) {
+			c->limit[i] = 16;
+		}
+
+		c->initialized = 1;
+	}
+
+	return c;
+}
+
+/*
+ * Returns the largest c such that 2^c <= bytes.
+ */
+static size_t darr_cache_class_floor(size_t bytes)
+{
+	size_t c = 0;
+
+	while (bytes >>= 1) {
+		c += 1;
+	}
+
+	return c;
+}
+
+/*
+ * Returns the smallest c such that 2^c >= bytes.
+ */
+static size_t darr_cache_class_ceil(size_t bytes)
+{
+	size_t c = darr_cache_class_floor(bytes);
+
+	return ((size_t) 1 << c) == bytes ? c : c + 1;
+}
+
+DARR_API int darr_cache_limit_set(size_t size_class, size_t limit)
+{
+	if (size_class >= DARR_CACHE_CLASSES) {
+		return 0;
+	}
+
+	darr_cache_get()->limit[size_class] = limit;
+	return 1;
+}
+
+DARR_API const struct darr_cache_stats *darr_cache_stats_get(void)
+{
+	return &darr_cache_get()->stats;
+}
+
+DARR_API void darr_cache_flush(void)
+{
+	struct darr_cache *c = darr_cache_get();
+
+	for (size_t i = 0; i < DARR_CACHE_CLASSES; ++i) {
+		while (c->head[i]) {
+			void *data = c->head[i];
+			memcpy(&c->head[i], data, sizeof(void *));
+			darr_mem_free(data);
+		}
+
+		c->count[i] = 0;
+	}
+}
+
+DARR_API void *darr_cache_take(size_t bytes)
+{
+	struct darr_cache *c = darr_cache_get();
+	size_t i = darr_cache_class_ceil(bytes);
+
+	if (i >= DARR_CACHE_CLASSES || c->head[i] == NULL) {
+		c->stats.misses += 1;
+		return NULL;
+	}
+
+	void *data = c->head[i];
+	memcpy(&c->head[i], data, sizeof(void *));
+	c->count[i] -= 1;
+	c->stats.hits += 1;
+	return data;
+}
+
+DARR_API int darr_cache_give(void *data, size_t bytes)
+{
+	struct darr_cache *c = darr_cache_get();
+	size_t i = darr_cache_class_floor(bytes);
+
+	// Buffers must be able to hold the pointer to the next one.
+	if (bytes < sizeof(void *)
+		|| i >= DARR_CACHE_CLASSES
+		|| c->count[i] >= c->limit[i]) {
+		c->stats.overflows += 1;
+		return 0;
+	}
+
+	memcpy(data, &c->head[i], sizeof(void *));
+	c->head[i] = data;
+	c->count[i] += 1;
+	c->stats.returns += 1;
+	return 1;
+}
+#endif
+
+#ifndef DARR_HEADER_ONLY
+extern inline void darr_global_realloc_set(darr_realloc_t f);
 
-darr_realloc_t darr_realloc = realloc;
+extern inline void darr_global_free_set(darr_free_t f);
 
-darr_free_t darr_free = free;
+extern inline void darr_global_calloc_set(darr_calloc_t f);
 
-extern inline void darr_global_realloc_set(darr_realloc_t f);
+extern inline void *darr_mem_realloc(void *p, size_t size);
 
-extern inline void darr_global_free_set(darr_free_t f);
+extern inline void darr_mem_free(void *p);
+
+extern inline darr_calloc_t darr_mem_calloc(void);
+
+extern inline void darr_global_data_move_set(
+	size_t threshold,
+	darr_data_move_t f);
+
+extern inline void darr_data_move(void *dst, const void *src, size_t bytes);
 
 extern inline size_t darr_data_index(const struct darr *d, size_t i);
 
@@ -14,6 +216,64 @@ extern inline size_t darr_data_size(const struct darr *d);
 
 extern inline void darr_init(struct darr *d, size_t element_size);
 
+extern inline void darr_init_aligned(
+	struct darr *d,
+	size_t element_size,
+	size_t alignment,
+	size_t padding);
+
+extern inline void darr_buffer_free(
+	char *data,
+	size_t bytes,
+	size_t alignment);
+
+extern inline size_t darr_buffer_aligned_bytes(
+	size_t bytes,
+	size_t alignment,
+	size_t padding);
+
+extern inline char *darr_buffer_align(char *raw, size_t alignment);
+
+extern inline char *darr_buffer_realloc(
+	char *data,
+	size_t old_bytes,
+	size_t bytes,
+	size_t alignment,
+	size_t padding);
+
+extern inline char *darr_buffer_realloc_zeroed(
+	char *data,
+	size_t old_bytes,
+	size_t bytes,
+	size_t alignment,
+	size_t padding);
+
+extern inline struct darr_view darr_view_slice(
+	const struct darr *d,
+	size_t start,
+	size_t size);
+
+extern inline struct darr_view darr_view_from(
+	const void *data,
+	size_t size,
+	size_t element_size);
+
+extern inline struct darr_view darr_view_all(const struct darr *d);
+
+extern inline size_t darr_view_size(struct darr_view v);
+
+extern inline const void *darr_view_data(struct darr_view v);
+
+extern inline const void *darr_view_element(struct darr_view v, size_t i);
+
+extern inline int darr_copy_view_aligned(
+	struct darr *d,
+	struct darr_view v,
+	size_t alignment,
+	size_t padding);
+
+extern inline int darr_copy_view(struct darr *d, struct darr_view v);
+
 extern inline int darr_copy(struct darr *d, const struct darr *other);
 
 extern inline int darr_copy_slice(
@@ -32,6 +292,8 @@ extern inline const void *darr_data_const(const struct darr *d);
 
 extern inline int darr_resize(struct darr *d, size_t size);
 
+extern inline int darr_resize_zeroed(struct darr *d, size_t size);
+
 extern inline void *darr_element(struct darr *d, size_t i);
 
 extern inline const void *darr_element_const(const struct darr *d, size_t i);
@@ -66,9 +328,13 @@ extern inline void darr_shift_slice_right(
 
 extern inline int darr_shrink(struct darr *d, size_t size);
 
+extern inline void darr_truncate(struct darr *d, size_t size);
+
 extern inline int darr_grow(struct darr *d, size_t size);
 
-extern inline void *darr_address(struct darr *d, size_t i);
+extern inline int darr_grow_zeroed(struct darr *d, size_t size);
+
+extern inline int darr_resize_fill(struct darr *d, size_t size, const void *e);
 
 extern inline void *darr_first(struct darr *d);
 
@@ -78,15 +344,29 @@ extern inline void *darr_last(struct darr *d);
 
 extern inline const void *darr_last_const(const struct darr *d);
 
+extern inline int darr_append_view(struct darr *d, struct darr_view v);
+
 extern inline int darr_append(struct darr *d, const struct darr *other);
 
+extern inline int darr_prepend_view(struct darr *d, struct darr_view v);
+
 extern inline int darr_prepend(struct darr *d, const struct darr *other);
 
+extern inline int darr_insert_view(
+	struct darr *d,
+	size_t i,
+	struct darr_view v);
+
 extern inline int darr_insert(
 	struct darr *d,
 	size_t i,
 	const struct darr *other);
 
+extern inline int darr_insert_many(
+	struct darr *d,
+	const struct darr_insert_op *ops,
+	size_t k);
+
 extern inline int darr_remove(struct darr *d, size_t start, size_t size);
 
 extern inline int darr_move_slice(
@@ -96,3 +376,475 @@ extern inline int darr_move_slice(
 	size_t s);
 
 extern inline int darr_move(struct darr *d, struct darr *other);
+#endif
+
+/*
+ * Number of elements ahead of the current one whose addresses are prefetched
+ * by the gather and scatter loops.
+ */
+#define DARR_PREFETCH_DISTANCE 16
+
+/*
+ * The loops below are written for any element size. They are called with
+ * constant sizes for common element sizes so that the compiler turns every
+ * memcpy into plain loads and stores.
+ */
+
+static inline void darr_swap_bytes(char *a, char *b, size_t size)
+{
+	char tmp[64];
+
+	while (size > 0) {
+		size_t n = size < sizeof(tmp) ? size : sizeof(tmp);
+
+		memcpy(tmp, a, n);
+		memcpy(a, b, n);
+		memcpy(b, tmp, n);
+		a += n;
+		b += n;
+		size -= n;
+	}
+}
+
+static inline void darr_reverse_bytes(char *p, size_t count, size_t size)
+{
+	char *lo = p;
+	char *hi = p + (count - 1) * size;
+
+	while (lo < hi) {
+		darr_swap_bytes(lo, hi, size);
+		lo += size;
+		hi -= size;
+	}
+}
+
+static inline void darr_gather_bytes(
+	char *dst,
+	const char *src,
+	const size_t *idx,
+	size_t count,
+	size_t size)
+{
+	for (size_t i = 0; i < count; ++i) {
+		if (i + DARR_PREFETCH_DISTANCE < count) {
+			__builtin_prefetch(
+				src + idx[i + DARR_PREFETCH_DISTANCE] * size,
+				0,
+				0);
+		}
+
+		memcpy(dst + i * size, src + idx[i] * size, size);
+	}
+}
+
+static inline void darr_scatter_bytes(
+	char *dst,
+	const char *src,
+	const size_t *idx,
+	size_t count,
+	size_t size)
+{
+	for (size_t i = 0; i < count; ++i) {
+		if (i + DARR_PREFETCH_DISTANCE < count) {
+			__builtin_prefetch(
+				dst + idx[i + DARR_PREFETCH_DISTANCE] * size,
+				1,
+				0);
+		}
+
+		memcpy(dst + idx[i] * size, src + i * size, size);
+	}
+}
+
+/*
+ * Calls one of the loops above with a constant element size when possible.
+ */
+#define DARR_SPECIALIZE(size, call) \
+	switch (size) { \
+	case 1: call(1); break; \
+	case 2: call(2); break; \
+	case 4: call(4); break; \
+	case 8: call(8); break; \
+	case 16: call(16); break; \
+	default: call(size); break; \
+	}
+
+DARR_API void darr_reverse(struct darr *d, size_t start, size_t size)
+{
+	if (size < 2) {
+		return;
+	}
+
+	char *p = d->data + darr_data_index(d, start);
+
+#define DARR_REVERSE(es) darr_reverse_bytes(p, size, es)
+	DARR_SPECIALIZE(d->element_size, DARR_REVERSE)
+#undef DARR_REVERSE
+}
+
+DARR_API void darr_rotate(struct darr *d, size_t start, size_t size, size_t k)
+{
+	if (size == 0 || k % size == 0) {
+		return;
+	}
+
+	k %= size;
+
+	char *p = d->data + darr_data_index(d, start);
+	size_t left = darr_data_index(d, k);
+	size_t right = darr_data_index(d, size - k);
+	char buffer[256];
+
+	if (left <= sizeof(buffer)) {
+		memcpy(buffer, p, left);
+		darr_data_move(p, p + left, right);
+		memcpy(p + right, buffer, left);
+		DARR_STATS_MEMMOVE(d, SHIFT, right);
+	} else if (right <= sizeof(buffer)) {
+		memcpy(buffer, p + left, right);
+		darr_data_move(p + right, p, left);
+		memcpy(p, buffer, right);
+		DARR_STATS_MEMMOVE(d, SHIFT, left);
+	} else {
+		darr_reverse(d, start, k);
+		darr_reverse(d, start + k, size - k);
+		darr_reverse(d, start, size);
+	}
+}
+
+DARR_API int darr_gather(
+	struct darr *dst,
+	const struct darr *src,
+	const struct darr *idx)
+{
+	size_t count = darr_size(idx);
+
+	if (!darr_resize(dst, count)) {
+		return 0;
+	}
+
+	if (count == 0) {
+		return 1;
+	}
+
+	char *out = dst->data;
+	const char *in = src->data;
+	const size_t *ix = (const size_t *) idx->data;
+
+#define DARR_GATHER(es) darr_gather_bytes(out, in, ix, count, es)
+	DARR_SPECIALIZE(src->element_size, DARR_GATHER)
+#undef DARR_GATHER
+
+	return 1;
+}
+
+DARR_API void darr_scatter(
+	struct darr *dst,
+	const struct darr *src,
+	const struct darr *idx)
+{
+	size_t count = darr_size(idx);
+
+	if (count == 0) {
+		return;
+	}
+
+	char *out = dst->data;
+	const char *in = src->data;
+	const size_t *ix = (const size_t *) idx->data;
+
+#define DARR_SCATTER(es) darr_scatter_bytes(out, in, ix, count, es)
+	DARR_SPECIALIZE(src->element_size, DARR_SCATTER)
+#undef DARR_SCATTER
+}
+
+/*
+ * How far ahead of the bytes being moved darr_data_move_stream asks for the
+ * bytes it will read next.
+ */
+#define DARR_STREAM_PREFETCH_DISTANCE 512
+
+#define DARR_STREAM_LINE 64
+
+/*
+ * Moves bytes with memmove, for CPUs without non-temporal stores.
+ */
+static void darr_data_move_stream_scalar(
+	void *dst,
+	const void *src,
+	size_t bytes)
+{
+	memmove(dst, src, bytes);
+}
+
+#ifdef DARR_CPU_X86
+DARR_CPU_TARGET("sse2")
+static void darr_data_move_stream_sse2(
+	void *dst,
+	const void *src,
+	size_t bytes)
+{
+	char *d = dst;
+	const char *s = src;
+
+	if (d == s) {
+		return;
+	}
+
+	// Every line is loaded in full before any of it is stored so lines may
+	// overlap. The destination is walked in the same direction as memmove
+	// would so that no byte is overwritten before it is read.
+	if (d < s) {
+		size_t head = -(uintptr_t) d % DARR_STREAM_LINE;
+		head = head < bytes ? head : bytes;
+		memmove(d, s, head);
+		d += head;
+		s += head;
+		bytes -= head;
+
+		while (bytes >= DARR_STREAM_LINE) {
+			_mm_prefetch(
+				s + DARR_STREAM_PREFETCH_DISTANCE,
+				_MM_HINT_NTA);
+			const __m128i *v = (const __m128i *) s;
+			__m128i a = _mm_loadu_si128(v);
+			__m128i b = _mm_loadu_si128(v + 1);
+			__m128i c = _mm_loadu_si128(v + 2);
+			__m128i e = _mm_loadu_si128(v + 3);
+			_mm_stream_si128((__m128i *) d, a);
+			_mm_stream_si128((__m128i *) (d + 16), b);
+			_mm_stream_si128((__m128i *) (d + 32), c);
+			_mm_stream_si128((__m128i *) (d + 48), e);
+			d += DARR_STREAM_LINE;
+			s += DARR_STREAM_LINE;
+			bytes -= DARR_STREAM_LINE;
+		}
+
+		_mm_sfence();
+		memmove(d, s, bytes);
+	} else {
+		char *d_end = d + bytes;
+		const char *s_end = s + bytes;
+		size_t tail = (uintptr_t) d_end % DARR_STREAM_LINE;
+		tail = tail < bytes ? tail : bytes;
+		d_end -= tail;
+		s_end -= tail;
+		memmove(d_end, s_end, tail);
+		bytes -= tail;
+
+		while (bytes >= DARR_STREAM_LINE) {
+			d_end -= DARR_STREAM_LINE;
+			s_end -= DARR_STREAM_LINE;
+			_mm_prefetch(
+				s_end - DARR_STREAM_PREFETCH_DISTANCE,
+				_MM_HINT_NTA);
+			const __m128i *v = (const __m128i *) s_end;
+			__m128i a = _mm_loadu_si128(v);
+			__m128i b = _mm_loadu_si128(v + 1);
+			__m128i c = _mm_loadu_si128(v + 2);
+			__m128i e = _mm_loadu_si128(v + 3);
+			_mm_stream_si128((__m128i *) d_end, a);
+			_mm_stream_si128((__m128i *) (d_end + 16), b);
+			_mm_stream_si128((__m128i *) (d_end + 32), c);
+			_mm_stream_si128((__m128i *) (d_end + 48), e);
+			bytes -= DARR_STREAM_LINE;
+		}
+
+		_mm_sfence();
+		memmove(d, s, bytes);
+	}
+}
+#endif
+
+/*
+ * The kernels of darr_data_move_stream for every level. Loads and stores of
+ * 32 bytes do not move memory any faster than those of 16 bytes once it
+ * misses the cache, so AVX2 uses the SSE2 kernel.
+ */
+static void (*const darr_data_move_stream_kernels[DARR_CPU_LEVELS])(
+	void *,
+	const void *,
+	size_t) = {
+#ifdef DARR_CPU_X86
+	darr_data_move_stream_scalar,
+	darr_data_move_stream_sse2,
+	darr_data_move_stream_sse2,
+	darr_data_move_stream_sse2,
+#else
+	darr_data_move_stream_scalar,
+	darr_data_move_stream_scalar,
+	darr_data_move_stream_scalar,
+	darr_data_move_stream_scalar,
+#endif
+};
+
+DARR_API void darr_data_move_stream(void *dst, const void *src, size_t bytes)
+{
+	darr_data_move_stream_kernels[darr_cpu_active](dst, src, bytes);
+}
+
+/*
+ * The largest block that darr_fill copies onto the bytes that follow it. Any
+ * larger and the copies would read back from memory what they just wrote
+ * instead of from the first level cache.
+ */
+#define DARR_FILL_BLOCK 4096
+
+/*
+ * The kernels of darr_fill_vector. Each fills bytes with a pattern of 32
+ * bytes and finishes by copying the start of the pattern, which is where
+ * the bytes left start since every kernel writes a multiple of 16 bytes.
+ */
+static void darr_fill_vector_scalar(char *p, size_t bytes, const char *pattern)
+{
+	size_t done = 0;
+
+	for (; done + 32 <= bytes; done += 32) {
+		memcpy(p + done, pattern, 32);
+	}
+
+	memcpy(p + done, pattern, bytes - done);
+}
+
+#ifdef DARR_CPU_X86
+DARR_CPU_TARGET("sse2")
+static void darr_fill_vector_sse2(char *p, size_t bytes, const char *pattern)
+{
+	__m128i v = _mm_load_si128((const __m128i *) pattern);
+	size_t done = 0;
+
+	for (; done + 64 <= bytes; done += 64) {
+		_mm_storeu_si128((__m128i *) (p + done), v);
+		_mm_storeu_si128((__m128i *) (p + done + 16), v);
+		_mm_storeu_si128((__m128i *) (p + done + 32), v);
+		_mm_storeu_si128((__m128i *) (p + done + 48), v);
+	}
+
+	for (; done + 16 <= bytes; done += 16) {
+		_mm_storeu_si128((__m128i *) (p + done), v);
+	}
+
+	memcpy(p + done, pattern, bytes - done);
+}
+
+DARR_CPU_TARGET("avx2")
+static void darr_fill_vector_avx2(char *p, size_t bytes, const char *pattern)
+{
+	__m256i v = _mm256_load_si256((const __m256i *) pattern);
+	size_t done = 0;
+
+	for (; done + 128 <= bytes; done += 128) {
+		_mm256_storeu_si256((__m256i *) (p + done), v);
+		_mm256_storeu_si256((__m256i *) (p + done + 32), v);
+		_mm256_storeu_si256((__m256i *) (p + done + 64), v);
+		_mm256_storeu_si256((__m256i *) (p + done + 96), v);
+	}
+
+	for (; done + 32 <= bytes; done += 32) {
+		_mm256_storeu_si256((__m256i *) (p + done), v);
+	}
+
+	memcpy(p + done, pattern, bytes - done);
+}
+#endif
+
+static void (*const darr_fill_vector_kernels[DARR_CPU_LEVELS])(
+	char *,
+	size_t,
+	const char *) = {
+#ifdef DARR_CPU_X86
+	darr_fill_vector_scalar,
+	darr_fill_vector_sse2,
+	darr_fill_vector_sse2,
+	darr_fill_vector_avx2,
+#else
+	darr_fill_vector_scalar,
+	darr_fill_vector_scalar,
+	darr_fill_vector_scalar,
+	darr_fill_vector_scalar,
+#endif
+};
+
+/*
+ * Fills bytes with a pattern whose length divides 16 by storing a vector
+ * that holds it repeated.
+ */
+static void darr_fill_vector(char *p, size_t bytes, const void *e, size_t size)
+{
+	_Alignas(32) char pattern[32];
+
+	for (size_t i = 0; i < sizeof(pattern); i += size) {
+		memcpy(pattern + i, e, size);
+	}
+
+	darr_fill_vector_kernels[darr_cpu_active](p, bytes, pattern);
+}
+
+/*
+ * Fills bytes with copies of an element of any size by copying the element
+ * once and then copying what has been filled onto what follows it.
+ *
+ * Kept out of line so that darr_fill stays small where it is inlined, which
+ * also keeps the compiler from warning about copying an element of a size it
+ * cannot rule out from a smaller object in header only mode.
+ */
+__attribute__((noinline))
+static void darr_fill_doubling(
+	char *p,
+	size_t bytes,
+	const void *e,
+	size_t size)
+{
+	memcpy(p, e, size);
+
+	// The filled part always holds whole elements, so copying it to the
+	// end of itself keeps elements aligned to their boundaries.
+	size_t done = size;
+
+	// Past the block size the copies keep reading the same block, the
+	// largest multiple of the element size that fits.
+	size_t block = size > DARR_FILL_BLOCK
+		? size
+		: DARR_FILL_BLOCK / size * size;
+
+	while (done < bytes) {
+		size_t n = done < block ? done : block;
+
+		if (n > bytes - done) {
+			n = bytes - done;
+		}
+
+		memcpy(p + done, p, n);
+		done += n;
+	}
+}
+
+DARR_API void darr_fill(
+	struct darr *d,
+	size_t start,
+	size_t count,
+	const void *e)
+{
+	if (count == 0) {
+		return;
+	}
+
+	size_t size = d->element_size;
+	char *p = d->data + darr_data_index(d, start);
+	size_t bytes = count * size;
+
+	switch (size) {
+	case 1:
+		memset(p, *(const unsigned char *) e, count);
+		break;
+	case 2:
+	case 4:
+	case 8:
+	case 16:
+		darr_fill_vector(p, bytes, e, size);
+		break;
+	default:
+		darr_fill_doubling(p, bytes, e, size);
+		break;
+	}
+}
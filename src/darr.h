@@ -1,30 +1,254 @@
 #ifndef DARR_DARR_H
 #define DARR_DARR_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef DARR_STATS
+#include <stdio.h>
+#endif
+
+/*
+ * Defining DARR_HEADER_ONLY before including darr.h makes it define every
+ * function of darr as static inline, including those that are otherwise
+ * compiled into the library. Programs then don't need to link with the
+ * library for them and the compiler can inline any of them without link
+ * time optimization. Global variables are static too, so global settings
+ * such as darr_global_realloc_set only apply to the file that changes them.
+ *
+ * Only darr.h and darr_cpu.h, which darr.h needs, work this way. The other
+ * modules still come from the library. Header only mode is not available in
+ * C++.
+ *
+ * These macros are an implementation detail. DARR_INLINE marks functions
+ * defined in headers, DARR_API functions defined in source files, and
+ * DARR_EXTERN and DARR_GLOBAL declarations and definitions of global
+ * variables.
+ */
+#ifdef DARR_HEADER_ONLY
+#ifdef __cplusplus
+#error "DARR_HEADER_ONLY is not available in C++."
+#endif
+#define DARR_INLINE static inline
+#define DARR_API static inline
+#define DARR_EXTERN static
+#define DARR_GLOBAL static
+#else
+#define DARR_INLINE inline
+#define DARR_API
+#define DARR_EXTERN extern
+#define DARR_GLOBAL
+#endif
+
+/*
+ * Defining DARR_REALLOC and DARR_FREE before including darr.h makes darr call
+ * the functions or macros they name instead of going through darr_realloc
+ * and darr_free, which lets the compiler inline your allocator. They must be
+ * declared before darr.h is included and take the same parameters as realloc
+ * and free. calloc is then never used.
+ *
+ * Every file that calls darr must see the same definitions, or buffers get
+ * freed by a different allocator than the one that allocated them. Either
+ * define them in header only mode or build the library with them too. The
+ * functions that set the global allocators have no effect then.
+ */
+#if defined(DARR_REALLOC) != defined(DARR_FREE)
+#error "DARR_REALLOC and DARR_FREE must be defined together."
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The alignment of the memory returned by malloc and realloc.
+ */
+#ifdef __cplusplus
+#define DARR_MALLOC_ALIGNMENT alignof(max_align_t)
+#else
+#define DARR_MALLOC_ALIGNMENT _Alignof(max_align_t)
+#endif
+
 typedef void *(*darr_realloc_t)(void *, size_t);
 typedef void (*darr_free_t)(void *);
+typedef void *(*darr_calloc_t)(size_t, size_t);
 
-extern darr_realloc_t darr_realloc;
-extern darr_free_t darr_free;
+DARR_EXTERN darr_realloc_t darr_realloc;
+DARR_EXTERN darr_free_t darr_free;
+DARR_EXTERN darr_calloc_t darr_calloc;
 
 /*
  * Allows you to override any call to realloc made by darr.
+ *
+ * This also stops darr from calling calloc, since memory from calloc may not
+ * be compatible with your free. Zeroed buffers are then allocated with your
+ * realloc and cleared with memset, unless you also call
+ * darr_global_calloc_set.
  */
-inline void darr_global_realloc_set(darr_realloc_t f)
+DARR_INLINE void darr_global_realloc_set(darr_realloc_t f)
 {
 	darr_realloc = f;
+	darr_calloc = NULL;
 }
 
 /*
  * Allows you to override any call to free made by darr.
+ *
+ * Like darr_global_realloc_set, this stops darr from calling calloc, since
+ * your free may not accept memory from calloc. Call darr_global_calloc_set
+ * afterwards to allocate zeroed buffers with a matching function.
  */
-inline void darr_global_free_set(darr_free_t f)
+DARR_INLINE void darr_global_free_set(darr_free_t f)
 {
 	darr_free = f;
+	darr_calloc = NULL;
+}
+
+/*
+ * Allows you to override any call to calloc made by darr. It is used to
+ * allocate buffers whose elements must start out as zero, because calloc can
+ * hand out pages that the operating system zeroes only once they are
+ * touched. NULL makes darr use realloc and memset instead.
+ */
+DARR_INLINE void darr_global_calloc_set(darr_calloc_t f)
+{
+	darr_calloc = f;
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Calls the realloc darr is set to use.
+ */
+DARR_INLINE void *darr_mem_realloc(void *p, size_t size)
+{
+#ifdef DARR_REALLOC
+	return DARR_REALLOC(p, size);
+#else
+	return darr_realloc(p, size);
+#endif
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Calls the free darr is set to use.
+ */
+DARR_INLINE void darr_mem_free(void *p)
+{
+#ifdef DARR_FREE
+	DARR_FREE(p);
+#else
+	darr_free(p);
+#endif
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Returns the calloc darr is set to use, or NULL if it must not use one.
+ */
+DARR_INLINE darr_calloc_t darr_mem_calloc(void)
+{
+#ifdef DARR_REALLOC
+	return NULL;
+#else
+	return darr_calloc;
+#endif
+}
+
+/*
+ * Moves bytes from src to dst. The two may overlap.
+ */
+typedef void (*darr_data_move_t)(void *dst, const void *src, size_t bytes);
+
+/*
+ * The default number of bytes from which shifting elements is handed to
+ * darr_data_move_large instead of memmove, which means never.
+ */
+#define DARR_DATA_MOVE_THRESHOLD SIZE_MAX
+
+DARR_EXTERN size_t darr_data_move_threshold;
+DARR_EXTERN darr_data_move_t darr_data_move_large;
+
+/*
+ * Allows you to override how darr moves elements around when shifting them
+ * by threshold bytes or more. Smaller moves always use memmove, as do all
+ * moves by default.
+ *
+ * memmove leaves everything it touches in the cache, so moving more bytes
+ * than the last level cache holds evicts the data of every other core that
+ * shares it. darr_data_move_stream avoids that and darr_parallel_data_move in
+ * darr_parallel.h also splits moves between threads. Whether either is
+ * faster than memmove depends on the machine; the shift benchmarks measure
+ * them.
+ */
+DARR_INLINE void darr_global_data_move_set(size_t threshold, darr_data_move_t f)
+{
+	darr_data_move_threshold = threshold;
+	darr_data_move_large = f;
+}
+
+/*
+ * Moves bytes from src to dst like memmove, but writes dst with non-temporal
+ * stores that bypass the cache. This is slower than memmove for data that
+ * fits in the cache and faster for data that does not. Falls back to
+ * memmove where SSE2 is not available.
+ */
+DARR_API void darr_data_move_stream(void *dst, const void *src, size_t bytes);
+
+/*
+ * Moves bytes from src to dst with memmove or, from the threshold set with
+ * darr_global_data_move_set, with the function set with it.
+ */
+DARR_INLINE void darr_data_move(void *dst, const void *src, size_t bytes)
+{
+	if (bytes >= darr_data_move_threshold) {
+		darr_data_move_large(dst, src, bytes);
+	} else {
+		memmove(dst, src, bytes);
+	}
+}
+
+#ifdef DARR_STATS
+/*
+ * The operations that copy or move elements around. Statistics on data
+ * movement are kept separately for each one of them.
+ */
+enum darr_stats_op {
+	DARR_STATS_OP_COPY,
+	DARR_STATS_OP_SHIFT,
+	DARR_STATS_OP_APPEND,
+	DARR_STATS_OP_PREPEND,
+	DARR_STATS_OP_INSERT,
+	DARR_STATS_OP_COUNT
+};
+
+/*
+ * Counters for allocations and data movement. Only available when darr is
+ * compiled with DARR_STATS defined.
+ *
+ * Every array keeps its own counters and a global set of counters adds up
+ * the activity of all arrays. The global counters are not thread safe.
+ */
+struct darr_stats {
+	size_t reallocs;
+	size_t frees;
+	size_t bytes_allocated;
+	size_t memmoves[DARR_STATS_OP_COUNT];
+	size_t bytes_memmoved[DARR_STATS_OP_COUNT];
+	size_t memcpys[DARR_STATS_OP_COUNT];
+	size_t bytes_memcpyed[DARR_STATS_OP_COUNT];
+};
+
+DARR_EXTERN struct darr_stats darr_stats_global;
+#endif
+
+#ifdef __cplusplus
 }
+#endif
 
 /*
  * The darr struct. You can initialize it by calling darr_init.
@@ -33,6 +257,204 @@ struct darr {
 	size_t element_size;
 	size_t size;
 	char *data;
+	size_t alignment;
+	size_t padding;
+#ifdef DARR_STATS
+	struct darr_stats stats;
+#endif
+#ifdef __cplusplus
+	/*
+	 * Typed C++ wrapper. Defined in darr.hpp.
+	 */
+	template<typename T> class array;
+#endif
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef DARR_STATS
+/*
+ * Sets all counters to zero.
+ */
+DARR_INLINE void darr_stats_reset(struct darr_stats *s)
+{
+	memset(s, 0, sizeof(*s));
+}
+
+/*
+ * Returns the counters of an array.
+ */
+DARR_INLINE const struct darr_stats *darr_stats_get(const struct darr *d)
+{
+	return &d->stats;
+}
+
+/*
+ * Returns the counters that add up the activity of all arrays.
+ */
+DARR_INLINE struct darr_stats *darr_stats_global_get(void)
+{
+	return &darr_stats_global;
+}
+
+/*
+ * Writes the counters in a human readable format to the given stream.
+ */
+DARR_API void darr_stats_dump(FILE *stream, const struct darr_stats *s);
+
+/*
+ * This is an implementation detail. Don't call this function.
+ */
+DARR_INLINE void darr_stats_record_realloc(struct darr_stats *s, size_t bytes)
+{
+	s->reallocs += 1;
+	s->bytes_allocated += bytes;
+	darr_stats_global.reallocs += 1;
+	darr_stats_global.bytes_allocated += bytes;
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ */
+DARR_INLINE void darr_stats_record_free(struct darr_stats *s)
+{
+	s->frees += 1;
+	darr_stats_global.frees += 1;
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ */
+DARR_INLINE void darr_stats_record_memmove(
+	struct darr_stats *s,
+	enum darr_stats_op op,
+	size_t bytes)
+{
+	s->memmoves[op] += 1;
+	s->bytes_memmoved[op] += bytes;
+	darr_stats_global.memmoves[op] += 1;
+	darr_stats_global.bytes_memmoved[op] += bytes;
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ */
+DARR_INLINE void darr_stats_record_memcpy(
+	struct darr_stats *s,
+	enum darr_stats_op op,
+	size_t bytes)
+{
+	s->memcpys[op] += 1;
+	s->bytes_memcpyed[op] += bytes;
+	darr_stats_global.memcpys[op] += 1;
+	darr_stats_global.bytes_memcpyed[op] += bytes;
+}
+
+#define DARR_STATS_INIT(d) darr_stats_reset(&(d)->stats)
+#define DARR_STATS_REALLOC(d, bytes) \
+	darr_stats_record_realloc(&(d)->stats, bytes)
+#define DARR_STATS_FREE(d) darr_stats_record_free(&(d)->stats)
+#define DARR_STATS_MEMMOVE(d, op, bytes) \
+	darr_stats_record_memmove(&(d)->stats, DARR_STATS_OP_##op, bytes)
+#define DARR_STATS_MEMCPY(d, op, bytes) \
+	darr_stats_record_memcpy(&(d)->stats, DARR_STATS_OP_##op, bytes)
+#else
+#define DARR_STATS_INIT(d) ((void) 0)
+#define DARR_STATS_REALLOC(d, bytes) ((void) 0)
+#define DARR_STATS_FREE(d) ((void) 0)
+#define DARR_STATS_MEMMOVE(d, op, bytes) ((void) 0)
+#define DARR_STATS_MEMCPY(d, op, bytes) ((void) 0)
+#endif
+
+#ifdef DARR_CACHE
+/*
+ * Counters of the buffer cache of a thread. Only available when darr is
+ * compiled with DARR_CACHE defined.
+ *
+ * hits and misses count requests for new buffers that were and were not
+ * served from the cache. returns counts buffers that were kept by the cache
+ * and overflows counts buffers that were freed because their size class was
+ * full.
+ */
+struct darr_cache_stats {
+	size_t hits;
+	size_t misses;
+	size_t returns;
+	size_t overflows;
+};
+
+/*
+ * The number of size classes of the buffer cache. Size class c holds buffers
+ * of at least 2^c bytes.
+ */
+#define DARR_CACHE_CLASSES 48
+
+/*
+ * When darr is compiled with DARR_CACHE defined, every thread keeps the
+ * buffers released by darr_deinit and by resizing arrays to zero, bucketed by
+ * power of two size classes, and reuses them when an empty array grows.
+ * Arrays initialized with darr_init_aligned and an alignment larger than
+ * malloc's do not use the cache.
+ *
+ * Sets the maximum number of buffers kept in a size class by the calling
+ * thread. A size class is the base 2 logarithm of the size of the buffers in
+ * bytes, so class 12 holds buffers of 4 KiB up to 8 KiB. By default up to 16
+ * buffers are kept for each class below 64 KiB and none for larger classes.
+ *
+ * Returns 1 on success, 0 if size_class is not below DARR_CACHE_CLASSES.
+ *
+ * On failure no limit is changed.
+ */
+DARR_API int darr_cache_limit_set(size_t size_class, size_t limit);
+
+/*
+ * Returns the counters of the buffer cache of the calling thread.
+ */
+DARR_API const struct darr_cache_stats *darr_cache_stats_get(void);
+
+/*
+ * Frees every buffer kept by the cache of the calling thread.
+ *
+ * Call this before a thread exits, otherwise its buffers leak, and before
+ * changing the functions set with darr_global_realloc_set and
+ * darr_global_free_set.
+ */
+DARR_API void darr_cache_flush(void);
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Returns a buffer of at least the given number of bytes from the cache or
+ * NULL if there is none.
+ */
+DARR_API void *darr_cache_take(size_t bytes);
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Offers a buffer of at least the given number of bytes to the cache. Returns
+ * 1 if the cache kept it and 0 if it must be freed.
+ */
+DARR_API int darr_cache_give(void *data, size_t bytes);
+#endif
+
+/*
+ * A read-only view of a range of elements of an array.
+ *
+ * A view does not own the elements it refers to. Creating one does not
+ * allocate or copy anything. You can create one by calling darr_view_all or
+ * darr_view_slice.
+ *
+ * A view is valid until either one of these events occur:
+ * - the size of the array it refers to changes.
+ * - the array it refers to is deinitialized.
+ */
+struct darr_view {
+	size_t element_size;
+	size_t size;
+	const char *data;
 };
 
 /*
@@ -41,7 +463,7 @@ struct darr {
  * Translates an index provided by the user to an index that can be used to
  * access an element.
  */
-inline size_t darr_data_index(const struct darr *d, size_t i)
+DARR_INLINE size_t darr_data_index(const struct darr *d, size_t i)
 {
 	return i * d->element_size;
 }
@@ -51,7 +473,7 @@ inline size_t darr_data_index(const struct darr *d, size_t i)
  *
  * Returns the total size of allocated memory.
  */
-inline size_t darr_data_size(const struct darr *d)
+DARR_INLINE size_t darr_data_size(const struct darr *d)
 {
 	return d->size * d->element_size;
 }
@@ -63,38 +485,371 @@ inline size_t darr_data_size(const struct darr *d)
  *
  * Call darr_deinit to deinitialize.
  */
-inline void darr_init(struct darr *d, size_t element_size)
+DARR_INLINE void darr_init(struct darr *d, size_t element_size)
 {
 	d->element_size = element_size;
 	d->size = 0;
 	d->data = NULL;
+	d->alignment = 0;
+	d->padding = 0;
+	DARR_STATS_INIT(d);
 }
 
 /*
- * Initializes a darr struct that will be a copy of another one.
+ * Initializes a darr struct whose elements will be stored at an address that
+ * is a multiple of the given alignment.
  *
- * Returns 1 on success, 0 on failure.
+ * The alignment must be a power of two. Alignments that malloc already
+ * guarantees cost nothing. Larger ones, such as 32 or 64 for SIMD loads or
+ * cache lines, make every resize allocate a new buffer and copy the elements
+ * over instead of growing in place.
  *
- * On failure, the darr struct is not initialized.
+ * The padding is a number of bytes that will always be allocated past the
+ * last element while the array is not empty, so that SIMD code may safely read
+ * past the end. Their contents are unspecified.
+ *
+ * Alignment and padding are kept by every function that reallocates the
+ * elements, and copies made with darr_copy and darr_copy_slice inherit them.
+ *
+ * You may not pass a struct that has already been initialized.
  *
  * Call darr_deinit to deinitialize.
  */
-inline int darr_copy(struct darr *d, const struct darr *other)
+DARR_INLINE void darr_init_aligned(
+	struct darr *d,
+	size_t element_size,
+	size_t alignment,
+	size_t padding)
+{
+	darr_init(d, element_size);
+
+	if (alignment > DARR_MALLOC_ALIGNMENT) {
+		d->alignment = alignment;
+	}
+
+	d->padding = padding;
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Releases a buffer allocated by darr_buffer_realloc. The bytes parameter is
+ * the size that was last requested for it, including padding.
+ */
+DARR_INLINE void darr_buffer_free(char *data, size_t bytes, size_t alignment)
 {
-	void *new = darr_realloc(NULL, darr_data_size(other));
+	if (alignment == 0) {
+#ifdef DARR_CACHE
+		if (darr_cache_give(data, bytes)) {
+			return;
+		}
+#else
+		(void) bytes;
+#endif
+
+		darr_mem_free(data);
+		return;
+	}
+
+	// Aligned buffers keep the address returned by the allocator right
+	// before the first element.
+	void *raw;
+	memcpy(&raw, data - sizeof(void *), sizeof(void *));
+	darr_mem_free(raw);
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Returns the number of bytes to allocate for a buffer with the given
+ * alignment so that there is room to align it and to store the address
+ * returned by the allocator.
+ */
+DARR_INLINE size_t darr_buffer_aligned_bytes(
+	size_t bytes,
+	size_t alignment,
+	size_t padding)
+{
+	return bytes + padding + alignment - 1 + sizeof(void *);
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Returns the first address past the start of a raw allocation that has the
+ * given alignment and room for a pointer before it, where the address of the
+ * raw allocation is stored.
+ */
+DARR_INLINE char *darr_buffer_align(char *raw, size_t alignment)
+{
+	uintptr_t start = (uintptr_t) (raw + sizeof(void *));
+	char *aligned = raw + sizeof(void *)
+		+ (alignment - start % alignment) % alignment;
+
+	memcpy(aligned - sizeof(void *), &raw, sizeof(void *));
+	return aligned;
+}
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Changes the size of a buffer, which may be NULL, to hold the given number
+ * of bytes of elements plus padding. Returns NULL on failure, in which case
+ * the old buffer is left untouched.
+ */
+DARR_INLINE char *darr_buffer_realloc(
+	char *data,
+	size_t old_bytes,
+	size_t bytes,
+	size_t alignment,
+	size_t padding)
+{
+	if (alignment == 0) {
+#ifdef DARR_CACHE
+		if (data == NULL) {
+			char *cached = (char *) darr_cache_take(
+				bytes + padding);
+
+			if (cached) {
+				return cached;
+			}
+		}
+#endif
+
+		return (char *) darr_mem_realloc(data, bytes + padding);
+	}
+
+	char *raw = (char *) darr_mem_realloc(
+		NULL,
+		darr_buffer_aligned_bytes(bytes, alignment, padding));
+
+	if (raw == NULL) {
+		return NULL;
+	}
+
+	char *aligned = darr_buffer_align(raw, alignment);
+
+	if (data) {
+		memcpy(aligned, data, old_bytes < bytes ? old_bytes : bytes);
+		darr_buffer_free(data, old_bytes + padding, alignment);
+	}
+
+	return aligned;
+}
+
+/*
+ * Buffers are grown with darr_buffer_realloc_zeroed into a fresh zeroed
+ * buffer instead of with realloc and memset if they at least double and
+ * become at least this many bytes large.
+ */
+#define DARR_ZEROED_FRESH_BYTES ((size_t) 128 << 10)
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Like darr_buffer_realloc, but bytes past old_bytes are set to zero.
+ *
+ * Buffers that grow a lot come from calloc and the old bytes are copied
+ * over. Large blocks from calloc are usually fresh pages from the operating
+ * system, which are zero already and only take up memory once touched, so
+ * the new bytes cost nothing until they are used. Otherwise they are
+ * cleared with memset.
+ */
+DARR_INLINE char *darr_buffer_realloc_zeroed(
+	char *data,
+	size_t old_bytes,
+	size_t bytes,
+	size_t alignment,
+	size_t padding)
+{
+	darr_calloc_t calloc_f = darr_mem_calloc();
+	int fresh = calloc_f != NULL
+		&& bytes > old_bytes
+		&& (data == NULL
+			|| (bytes - old_bytes >= old_bytes
+				&& bytes >= DARR_ZEROED_FRESH_BYTES));
+
+	if (!fresh) {
+		char *new_data = darr_buffer_realloc(
+			data,
+			old_bytes,
+			bytes,
+			alignment,
+			padding);
+
+		if (new_data != NULL && bytes > old_bytes) {
+			memset(new_data + old_bytes, 0, bytes - old_bytes);
+		}
+
+		return new_data;
+	}
+
+	char *new_data;
+
+	if (alignment == 0) {
+		new_data = (char *) calloc_f(1, bytes + padding);
+	} else {
+		new_data = (char *) calloc_f(
+			1,
+			darr_buffer_aligned_bytes(bytes, alignment, padding));
+
+		if (new_data != NULL) {
+			new_data = darr_buffer_align(new_data, alignment);
+		}
+	}
+
+	if (new_data == NULL) {
+		return NULL;
+	}
 
-	if (new == NULL) {
+	if (data) {
+		memcpy(new_data, data, old_bytes);
+		darr_buffer_free(data, old_bytes + padding, alignment);
+	}
+
+	return new_data;
+}
+
+/*
+ * Returns a view of a slice of the array.
+ *
+ * The start parameter must be an index into the array that denotes where the
+ * slice starts. The size parameter must not exceed the size of the array
+ * counting from the given index.
+ */
+DARR_INLINE struct darr_view darr_view_slice(
+	const struct darr *d,
+	size_t start,
+	size_t size)
+{
+	struct darr_view v;
+
+	v.element_size = d->element_size;
+	v.size = size;
+	v.data = d->data + darr_data_index(d, start);
+	return v;
+}
+
+/*
+ * Returns a view of size elements of element_size bytes each that starts at
+ * the given address. This lets you pass memory that is not owned by an array
+ * to functions that take views.
+ */
+DARR_INLINE struct darr_view darr_view_from(
+	const void *data,
+	size_t size,
+	size_t element_size)
+{
+	struct darr_view v;
+
+	v.element_size = element_size;
+	v.size = size;
+	v.data = (const char *) data;
+	return v;
+}
+
+/*
+ * Returns a view of all elements of the array.
+ */
+DARR_INLINE struct darr_view darr_view_all(const struct darr *d)
+{
+	return darr_view_slice(d, 0, d->size);
+}
+
+/*
+ * Returns the number of elements in the view.
+ */
+DARR_INLINE size_t darr_view_size(struct darr_view v)
+{
+	return v.size;
+}
+
+/*
+ * Returns a pointer to the first element of the view.
+ *
+ * The restrictions for the pointers returned by darr_view_element apply.
+ */
+DARR_INLINE const void *darr_view_data(struct darr_view v)
+{
+	return v.data;
+}
+
+/*
+ * Returns a pointer to an element of the view by index.
+ *
+ * The pointer is valid for as long as the view is valid.
+ *
+ * If the view is empty, the returned pointer is invalid.
+ */
+DARR_INLINE const void *darr_view_element(struct darr_view v, size_t i)
+{
+	return v.data + i * v.element_size;
+}
+
+/*
+ * Like darr_copy_view, but the copy will have the given alignment and padding
+ * as described in darr_init_aligned.
+ */
+DARR_INLINE int darr_copy_view_aligned(
+	struct darr *d,
+	struct darr_view v,
+	size_t alignment,
+	size_t padding)
+{
+	darr_init_aligned(d, v.element_size, alignment, padding);
+
+	char *new_data = darr_buffer_realloc(
+		NULL,
+		0,
+		v.size * v.element_size,
+		d->alignment,
+		d->padding);
+
+	if (new_data == NULL) {
 		return 0;
 	}
 
-	memcpy(new, other->data, darr_data_size(other));
+	memcpy(new_data, v.data, v.size * v.element_size);
 
-	d->element_size = other->element_size;
-	d->size = other->size;
-	d->data = new;
+	d->size = v.size;
+	d->data = new_data;
+	DARR_STATS_REALLOC(d, darr_data_size(d));
+	DARR_STATS_MEMCPY(d, COPY, darr_data_size(d));
 	return 1;
 }
 
+/*
+ * Initializes a darr struct that will be a copy of the elements of a view.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure, the darr struct is not initialized.
+ *
+ * Call darr_deinit to deinitialize.
+ */
+DARR_INLINE int darr_copy_view(struct darr *d, struct darr_view v)
+{
+	return darr_copy_view_aligned(d, v, 0, 0);
+}
+
+/*
+ * Initializes a darr struct that will be a copy of another one.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure, the darr struct is not initialized.
+ *
+ * Call darr_deinit to deinitialize.
+ */
+DARR_INLINE int darr_copy(struct darr *d, const struct darr *other)
+{
+	return darr_copy_view_aligned(
+		d,
+		darr_view_all(other),
+		other->alignment,
+		other->padding);
+}
+
 /*
  * Initializes a darr struct that will be a copy of a slice of another one.
  *
@@ -104,28 +859,17 @@ inline int darr_copy(struct darr *d, const struct darr *other)
  *
  * Call darr_deinit to deinitialize.
  */
-inline int darr_copy_slice(
+DARR_INLINE int darr_copy_slice(
 	struct darr *d,
 	const struct darr *other,
 	size_t i,
 	size_t s)
 {
-	void *new = darr_realloc(NULL, darr_data_size(other));
-
-	if (new == NULL) {
-		return 0;
-	}
-
-	d->data = new;
-	d->element_size = other->element_size;
-	d->size = s;
-
-	memcpy(
-		d->data,
-		other->data + darr_data_index(other, i),
-		darr_data_index(d, d->size));
-
-	return 1;
+	return darr_copy_view_aligned(
+		d,
+		darr_view_slice(other, i, s),
+		other->alignment,
+		other->padding);
 }
 
 /*
@@ -134,17 +878,21 @@ inline int darr_copy_slice(
  * The struct must have been previously initialized with either darr_init or
  * darr_copy. You may not pass a struct that has not been initialized.
  */
-inline void darr_deinit(struct darr *d)
+DARR_INLINE void darr_deinit(struct darr *d)
 {
 	if (d->data) {
-		darr_free(d->data);
+		darr_buffer_free(
+			d->data,
+			darr_data_size(d) + d->padding,
+			d->alignment);
+		DARR_STATS_FREE(d);
 	}
 }
 
 /*
  * Returns the current size of the array.
  */
-inline size_t darr_size(const struct darr *d)
+DARR_INLINE size_t darr_size(const struct darr *d)
 {
 	return d->size;
 }
@@ -156,7 +904,7 @@ inline size_t darr_size(const struct darr *d)
  *
  * The restrictions for the pointers returned by darr_element apply.
  */
-inline void *darr_data(struct darr *d)
+DARR_INLINE void *darr_data(struct darr *d)
 {
 	return d->data;
 }
@@ -164,7 +912,7 @@ inline void *darr_data(struct darr *d)
 /*
  * Like darr_data, but returns a const pointer.
  */
-inline const void *darr_data_const(const struct darr *d)
+DARR_INLINE const void *darr_data_const(const struct darr *d)
 {
 	return darr_data((struct darr *) d);
 }
@@ -179,7 +927,7 @@ inline const void *darr_data_const(const struct darr *d)
  * If the new size is the same as the current one, this function will do
  * nothing and report success.
  */
-inline int darr_resize(struct darr *d, size_t size)
+DARR_INLINE int darr_resize(struct darr *d, size_t size)
 {
 	if (size == d->size) {
 		return 1;
@@ -187,7 +935,11 @@ inline int darr_resize(struct darr *d, size_t size)
 
 	if (size == 0) {
 		if (d->data) {
-			darr_free(d->data);
+			darr_buffer_free(
+				d->data,
+				darr_data_size(d) + d->padding,
+				d->alignment);
+			DARR_STATS_FREE(d);
 			d->data = NULL;
 		}
 
@@ -195,14 +947,55 @@ inline int darr_resize(struct darr *d, size_t size)
 		return 1;
 	}
 
-	void *new = darr_realloc(d->data, size * d->element_size);
+	char *new_data = darr_buffer_realloc(
+		d->data,
+		darr_data_size(d),
+		size * d->element_size,
+		d->alignment,
+		d->padding);
 
-	if (new == NULL) {
+	if (new_data == NULL) {
 		return 0;
 	}
 
+	DARR_STATS_REALLOC(d, size * d->element_size);
+
 	d->size = size;
-	d->data = new;
+	d->data = new_data;
+	return 1;
+}
+
+/*
+ * Like darr_resize, but elements added past the old size are set to all
+ * bytes zero.
+ *
+ * Growing an array to at least twice its size and at least
+ * DARR_ZEROED_FRESH_BYTES bytes, or growing an empty one, allocates the
+ * buffer with calloc, so that pages the operating system hands out already
+ * zeroed are not written to until the elements on them are. Other sizes are
+ * cleared with memset.
+ */
+DARR_INLINE int darr_resize_zeroed(struct darr *d, size_t size)
+{
+	if (size <= d->size) {
+		return darr_resize(d, size);
+	}
+
+	char *new_data = darr_buffer_realloc_zeroed(
+		d->data,
+		darr_data_size(d),
+		size * d->element_size,
+		d->alignment,
+		d->padding);
+
+	if (new_data == NULL) {
+		return 0;
+	}
+
+	DARR_STATS_REALLOC(d, size * d->element_size);
+
+	d->size = size;
+	d->data = new_data;
 	return 1;
 }
 
@@ -219,7 +1012,7 @@ inline int darr_resize(struct darr *d, size_t size)
  *
  * Dereferencing an invalid pointer results in undefined behavior.
  */
-inline void *darr_element(struct darr *d, size_t i)
+DARR_INLINE void *darr_element(struct darr *d, size_t i)
 {
 	return d->data + darr_data_index(d, i);
 }
@@ -227,7 +1020,7 @@ inline void *darr_element(struct darr *d, size_t i)
 /*
  * Like darr_element, but returns a const pointer.
  */
-inline const void *darr_element_const(const struct darr *d, size_t i)
+DARR_INLINE const void *darr_element_const(const struct darr *d, size_t i)
 {
 	return darr_element((struct darr *) d, i);
 }
@@ -242,7 +1035,7 @@ inline const void *darr_element_const(const struct darr *d, size_t i)
  *
  * The purpose of this function is to implement the iterator pattern from C++
  */
-inline void *darr_begin(struct darr *d)
+DARR_INLINE void *darr_begin(struct darr *d)
 {
 	return darr_element(d, 0);
 }
@@ -250,7 +1043,7 @@ inline void *darr_begin(struct darr *d)
 /*
  * Like darr_begin, but returns a const pointer.
  */
-inline const void *darr_begin_const(const struct darr *d)
+DARR_INLINE const void *darr_begin_const(const struct darr *d)
 {
 	return darr_begin((struct darr *) d);
 }
@@ -264,7 +1057,7 @@ inline const void *darr_begin_const(const struct darr *d)
  *
  * The purpose of this function is to implement the iterator pattern from C++.
  */
-inline void *darr_end(struct darr *d)
+DARR_INLINE void *darr_end(struct darr *d)
 {
 	return darr_element(d, darr_size(d));
 }
@@ -272,7 +1065,7 @@ inline void *darr_end(struct darr *d)
 /*
  * Like darr_end, but returns a const pointer.
  */
-inline const void *darr_end_const(const struct darr *d)
+DARR_INLINE const void *darr_end_const(const struct darr *d)
 {
 	return darr_end((struct darr *) d);
 }
@@ -283,7 +1076,7 @@ inline const void *darr_end_const(const struct darr *d)
  * The arrays must have elements of the same size but the number of elements
  * may differ.
  */
-inline void darr_swap(struct darr *d, struct darr *other)
+DARR_INLINE void darr_swap(struct darr *d, struct darr *other)
 {
 	struct darr tmp;
 
@@ -295,7 +1088,7 @@ inline void darr_swap(struct darr *d, struct darr *other)
 /*
  * Returns 1 if the array is empty otherwise it returns 0.
  */
-inline int darr_empty(const struct darr *d)
+DARR_INLINE int darr_empty(const struct darr *d)
 {
 	return d->size == 0;
 }
@@ -307,12 +1100,13 @@ inline int darr_empty(const struct darr *d)
  * Steps may not be greater than the size of the array otherwise behavior is
  * undefined.
  */
-inline void darr_shift_left(struct darr *d, size_t steps)
+DARR_INLINE void darr_shift_left(struct darr *d, size_t steps)
 {
 	size_t offset = darr_data_index(d, steps);
 	size_t size = darr_data_size(d);
 
-	memmove(d->data, d->data + offset, size - offset);
+	darr_data_move(d->data, d->data + offset, size - offset);
+	DARR_STATS_MEMMOVE(d, SHIFT, size - offset);
 }
 
 /*
@@ -329,7 +1123,7 @@ inline void darr_shift_left(struct darr *d, size_t steps)
  * The steps parameter may not be greater than the size of the array plus the
  * given start index.
  */
-inline void darr_shift_slice_left(
+DARR_INLINE void darr_shift_slice_left(
 	struct darr *d,
 	size_t steps,
 	size_t start,
@@ -339,10 +1133,11 @@ inline void darr_shift_slice_left(
 	size_t data_start = darr_data_index(d, start);
 	size_t data_size = darr_data_index(d, size) - data_offset;
 
-	memmove(
+	darr_data_move(
 		d->data + data_start,
 		d->data + data_start + data_offset,
 		data_size);
+	DARR_STATS_MEMMOVE(d, SHIFT, data_size);
 }
 
 /*
@@ -352,12 +1147,13 @@ inline void darr_shift_slice_left(
  * Steps may not be greater than the size of the array otherwise behavior is
  * undefined.
  */
-inline void darr_shift_right(struct darr *d, size_t steps)
+DARR_INLINE void darr_shift_right(struct darr *d, size_t steps)
 {
 	size_t offset = darr_data_index(d, steps);
 	size_t size = darr_data_size(d);
 
-	memmove(d->data + offset, d->data, size - offset);
+	darr_data_move(d->data + offset, d->data, size - offset);
+	DARR_STATS_MEMMOVE(d, SHIFT, size - offset);
 }
 
 /*
@@ -374,7 +1170,7 @@ inline void darr_shift_right(struct darr *d, size_t steps)
  * The steps parameter may not be greater than the size of the array plus the
  * given start index.
  */
-inline void darr_shift_slice_right(
+DARR_INLINE void darr_shift_slice_right(
 	struct darr *d,
 	size_t steps,
 	size_t start,
@@ -384,10 +1180,11 @@ inline void darr_shift_slice_right(
 	size_t data_start = darr_data_index(d, start);
 	size_t data_size = darr_data_index(d, size) - data_offset;
 
-	memmove(
+	darr_data_move(
 		d->data + data_start + data_offset,
 		d->data + data_start,
 		data_size);
+	DARR_STATS_MEMMOVE(d, SHIFT, data_size);
 }
 
 /*
@@ -400,11 +1197,25 @@ inline void darr_shift_slice_right(
  * Behavior is undefined if the given amount is less than the size of the
  * array.
  */
-inline int darr_shrink(struct darr *d, size_t size)
+DARR_INLINE int darr_shrink(struct darr *d, size_t size)
 {
 	return darr_resize(d, darr_size(d) - size);
 }
 
+/*
+ * Decreases the size of the array to the given size, which must not be
+ * larger than the current one.
+ *
+ * Unlike darr_resize this never fails. If the buffer cannot be shrunk the
+ * array keeps the one it has, which is then merely larger than needed.
+ */
+DARR_INLINE void darr_truncate(struct darr *d, size_t size)
+{
+	if (!darr_resize(d, size)) {
+		d->size = size;
+	}
+}
+
 /*
  * Increases the size of the array by a given amount.
  *
@@ -412,23 +1223,18 @@ inline int darr_shrink(struct darr *d, size_t size)
  *
  * On failure the size and the contents of the array remain untouched.
  */
-inline int darr_grow(struct darr *d, size_t size)
+DARR_INLINE int darr_grow(struct darr *d, size_t size)
 {
 	return darr_resize(d, darr_size(d) + size);
 }
 
 /*
- * This function is deprecated, use darr_element instead.
- *
- * Additionally to doing everything that darr_element does, it guarantees that
- * it will return the same address as darr_end if it is passed the size of the
- * array as the index.
- *
- * This will be removed in version 2.
+ * Like darr_grow, but the new elements are set to all bytes zero. See
+ * darr_resize_zeroed.
  */
-inline void *darr_address(struct darr *d, size_t i)
+DARR_INLINE int darr_grow_zeroed(struct darr *d, size_t size)
 {
-	return darr_element(d, i);
+	return darr_resize_zeroed(d, darr_size(d) + size);
 }
 
 /*
@@ -438,7 +1244,7 @@ inline void *darr_address(struct darr *d, size_t i)
  *
  * The restrictions for the pointers returned by darr_element apply.
  */
-inline void *darr_first(struct darr *d)
+DARR_INLINE void *darr_first(struct darr *d)
 {
 	return darr_element(d, 0);
 }
@@ -446,7 +1252,7 @@ inline void *darr_first(struct darr *d)
 /*
  * Like darr_first, but returns a const pointer.
  */
-inline const void *darr_first_const(const struct darr *d)
+DARR_INLINE const void *darr_first_const(const struct darr *d)
 {
 	return darr_first((struct darr *) d);
 }
@@ -458,7 +1264,7 @@ inline const void *darr_first_const(const struct darr *d)
  *
  * The restrictions for the pointers returned by darr_element apply.
  */
-inline void *darr_last(struct darr *d)
+DARR_INLINE void *darr_last(struct darr *d)
 {
 	return darr_element(d, darr_size(d) - 1);
 }
@@ -466,11 +1272,35 @@ inline void *darr_last(struct darr *d)
 /*
  * Like darr_last, but returns a const pointer.
  */
-inline const void *darr_last_const(const struct darr *d)
+DARR_INLINE const void *darr_last_const(const struct darr *d)
 {
 	return darr_last((struct darr *) d);
 }
 
+/*
+ * Copies the elements of a view to the end of the array.
+ *
+ * The view must have elements of the same size as the array and may not
+ * refer to the array itself otherwise behavior is undefined.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the size and the contents of the array remain untouched.
+ */
+DARR_INLINE int darr_append_view(struct darr *d, struct darr_view v)
+{
+	size_t offset = darr_size(d);
+
+	if (!darr_grow(d, v.size)) {
+		return 0;
+	}
+
+	memcpy(darr_element(d, offset), v.data, v.size * v.element_size);
+	DARR_STATS_MEMCPY(d, APPEND, v.size * v.element_size);
+
+	return 1;
+}
+
 /*
  * Copies the elements of another array to the end of the array.
  *
@@ -481,15 +1311,31 @@ inline const void *darr_last_const(const struct darr *d)
  *
  * On failure the size and the contents of the array remain untouched.
  */
-inline int darr_append(struct darr *d, const struct darr *other)
+DARR_INLINE int darr_append(struct darr *d, const struct darr *other)
 {
-	size_t offset = darr_size(d);
+	return darr_append_view(d, darr_view_all(other));
+}
 
-	if (!darr_grow(d, darr_size(other))) {
+/*
+ * Copies the elements of a view to the start of the array.
+ *
+ * The view must have elements of the same size as the array and may not
+ * refer to the array itself otherwise behavior is undefined.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the size and the contents of the array remain untouched.
+ */
+DARR_INLINE int darr_prepend_view(struct darr *d, struct darr_view v)
+{
+	if (!darr_grow(d, v.size)) {
 		return 0;
 	}
 
-	memcpy(darr_element(d, offset), other->data, darr_data_size(other));
+	darr_shift_right(d, v.size);
+
+	memcpy(d->data, v.data, v.size * v.element_size);
+	DARR_STATS_MEMCPY(d, PREPEND, v.size * v.element_size);
 
 	return 1;
 }
@@ -504,15 +1350,34 @@ inline int darr_append(struct darr *d, const struct darr *other)
  *
  * On failure the size and the contents of the array remain untouched.
  */
-inline int darr_prepend(struct darr *d, const struct darr *other)
+DARR_INLINE int darr_prepend(struct darr *d, const struct darr *other)
 {
-	if (!darr_grow(d, darr_size(other))) {
+	return darr_prepend_view(d, darr_view_all(other));
+}
+
+/*
+ * Copies the elements of a view to the given index in the array.
+ *
+ * The view must have elements of the same size as the array and may not
+ * refer to the array itself otherwise behavior is undefined.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the size and the contents of the array remain untouched.
+ */
+DARR_INLINE int darr_insert_view(struct darr *d, size_t i, struct darr_view v)
+{
+	if (!darr_grow(d, v.size)) {
 		return 0;
 	}
 
-	darr_shift_right(d, darr_size(other));
+	darr_shift_slice_right(d, v.size, i, darr_size(d) - i);
 
-	memcpy(d->data, other->data, darr_data_size(other));
+	memcpy(
+		d->data + darr_data_index(d, i),
+		v.data,
+		v.size * v.element_size);
+	DARR_STATS_MEMCPY(d, INSERT, v.size * v.element_size);
 
 	return 1;
 }
@@ -527,18 +1392,78 @@ inline int darr_prepend(struct darr *d, const struct darr *other)
  *
  * On failure the size and the contents of the array remain untouched.
  */
-inline int darr_insert(struct darr *d, size_t i, const struct darr *other)
+DARR_INLINE int darr_insert(struct darr *d, size_t i, const struct darr *other)
+{
+	return darr_insert_view(d, i, darr_view_all(other));
+}
+
+/*
+ * Describes one of the insertions performed by darr_insert_many.
+ *
+ * The index refers to a position in the array before any of the insertions
+ * take place. src points to count elements.
+ */
+struct darr_insert_op {
+	size_t index;
+	const void *src;
+	size_t count;
+};
+
+/*
+ * Performs several insertions at once.
+ *
+ * The operations must be sorted by index in ascending order. Elements of
+ * operations with the same index are inserted in the order they are given.
+ * The sources may not point into the array itself.
+ *
+ * The array is resized once and every element is moved at most once, which
+ * is much faster than calling darr_insert for each operation.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the size and the contents of the array remain untouched.
+ */
+DARR_INLINE int darr_insert_many(
+	struct darr *d,
+	const struct darr_insert_op *ops,
+	size_t k)
 {
-	if (!darr_grow(d, darr_size(other))) {
+	size_t total = 0;
+
+	for (size_t j = 0; j < k; ++j) {
+		total += ops[j].count;
+	}
+
+	size_t end = darr_size(d);
+
+	if (!darr_grow(d, total)) {
 		return 0;
 	}
 
-	darr_shift_slice_right(d, darr_size(other), i, darr_size(d) - i);
+	size_t shift = total;
 
-	memcpy(
-		d->data + darr_data_index(d, i),
-		other->data,
-		darr_data_size(other));
+	for (size_t j = k; j > 0 && shift > 0; --j) {
+		const struct darr_insert_op *op = &ops[j - 1];
+		size_t moved = darr_data_index(d, end - op->index);
+
+		if (moved > 0) {
+			darr_data_move(
+				d->data + darr_data_index(d, op->index + shift),
+				d->data + darr_data_index(d, op->index),
+				moved);
+			DARR_STATS_MEMMOVE(d, INSERT, moved);
+		}
+
+		shift -= op->count;
+
+		memcpy(
+			d->data + darr_data_index(d, op->index + shift),
+			op->src,
+			darr_data_index(d, op->count));
+		DARR_STATS_MEMCPY(d, INSERT, darr_data_index(d, op->count));
+
+		end = op->index;
+	}
 
 	return 1;
 }
@@ -548,7 +1473,7 @@ inline int darr_insert(struct darr *d, size_t i, const struct darr *other)
  *
  * Returns 1 on success, 0 on failure.
  */
-inline int darr_remove(struct darr *d, size_t start, size_t size)
+DARR_INLINE int darr_remove(struct darr *d, size_t start, size_t size)
 {
 	darr_shift_slice_left(d, size, start, darr_size(d) - start);
 
@@ -575,7 +1500,11 @@ inline int darr_remove(struct darr *d, size_t start, size_t size)
  *
  * Call darr_deinit to deinitialize.
  */
-inline int darr_move_slice(struct darr *d, struct darr *other, size_t i, size_t s)
+DARR_INLINE int darr_move_slice(
+	struct darr *d,
+	struct darr *other,
+	size_t i,
+	size_t s)
 {
 	if (!darr_copy_slice(d, other, i, s)) {
 		return 0;
@@ -601,9 +1530,111 @@ inline int darr_move_slice(struct darr *d, struct darr *other, size_t i, size_t
  *
  * Call darr_deinit to deinitialize.
  */
-inline int darr_move(struct darr *d, struct darr *other)
+DARR_INLINE int darr_move(struct darr *d, struct darr *other)
 {
 	return darr_move_slice(d, other, 0, darr_size(other));
 }
 
+/*
+ * Reverses the order of a range of elements in place.
+ *
+ * The start parameter must be an index into the array that denotes where the
+ * range starts and size must not exceed the number of elements from there to
+ * the end of the array.
+ */
+DARR_API void darr_reverse(struct darr *d, size_t start, size_t size);
+
+/*
+ * Rotates a range of elements in place so that the element k positions after
+ * start becomes the first one of the range. The k elements that come before
+ * it are moved to the end of the range.
+ *
+ * The start and size parameters follow the same rules as in darr_reverse. k
+ * may be any number, it is taken modulo size.
+ *
+ * Does not allocate. Rotations that move few elements past many others go
+ * through a small buffer on the stack and a single memmove; larger ones are
+ * done with three reversals.
+ */
+DARR_API void darr_rotate(struct darr *d, size_t start, size_t size, size_t k);
+
+/*
+ * Resizes dst to the size of idx, which must be an array of size_t, and sets
+ * element i of dst to the element of src at index idx[i].
+ *
+ * dst and src must have the same element size and must not be the same
+ * array. Every index must be smaller than the size of src.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure dst remains untouched.
+ */
+DARR_API int darr_gather(
+	struct darr *dst,
+	const struct darr *src,
+	const struct darr *idx);
+
+/*
+ * Sets the element of dst at index idx[i] to element i of src, for every
+ * element of idx, which must be an array of size_t with at most as many
+ * elements as src.
+ *
+ * dst and src must have the same element size and must not be the same
+ * array. Every index must be smaller than the size of dst. If an index
+ * appears more than once, the last element of src written to it wins.
+ */
+DARR_API void darr_scatter(
+	struct darr *dst,
+	const struct darr *src,
+	const struct darr *idx);
+
+/*
+ * Sets count elements starting at index start to copies of the element e,
+ * which must not point into that range.
+ *
+ * The start and count parameters follow the same rules as the start and size
+ * parameters of darr_reverse.
+ *
+ * Elements of 1 byte are set with memset and elements of 2, 4, 8 and 16
+ * bytes with vector stores of the element repeated. Other sizes copy the
+ * element once and then copy what has been filled onto what follows it,
+ * doubling it every time until it reaches a few kilobytes.
+ */
+DARR_API void darr_fill(
+	struct darr *d,
+	size_t start,
+	size_t count,
+	const void *e);
+
+/*
+ * Like darr_resize, but elements added past the old size are set to copies
+ * of the element e, which must not point into the array.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the size and the contents of the array remain untouched.
+ */
+DARR_INLINE int darr_resize_fill(struct darr *d, size_t size, const void *e)
+{
+	size_t old_size = darr_size(d);
+
+	if (!darr_resize(d, size)) {
+		return 0;
+	}
+
+	if (size > old_size) {
+		darr_fill(d, old_size, size - old_size, e);
+	}
+
+	return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef DARR_HEADER_ONLY
+#include "darr.c"
+#endif
+
 #endif /* DARR_DARR_H */
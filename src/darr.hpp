@@ -0,0 +1,402 @@
+#ifndef DARR_DARR_HPP
+#define DARR_DARR_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "darr.h"
+
+/*
+ * A typed wrapper around struct darr for C++.
+ *
+ * The array owns its elements and releases them when it goes out of scope.
+ * Its only data member is a struct darr so it has the same size and layout
+ * and can be handed to C code with c_darr.
+ *
+ * Elements are moved around with memcpy and memmove so the element type must
+ * be trivially copyable.
+ *
+ * Like the C functions, operations that may allocate report failure by
+ * returning false instead of throwing.
+ */
+template<typename T>
+class darr::array {
+	static_assert(
+		std::is_trivially_copyable<T>::value,
+		"darr can only store trivially copyable types");
+
+public:
+	typedef T value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	/*
+	 * The size of each element, known at compile time.
+	 */
+	static constexpr size_type element_size = sizeof(T);
+
+	/*
+	 * Creates an empty array.
+	 */
+	array() noexcept
+	{
+		darr_init(&d, element_size);
+	}
+
+	/*
+	 * Takes ownership of the elements of an initialized struct darr.
+	 *
+	 * The struct must hold elements of type T. It is left empty.
+	 */
+	explicit array(struct darr &&other) noexcept
+	{
+		d = other;
+		darr_init(&other, element_size);
+	}
+
+	array(array &&other) noexcept
+	{
+		d = other.d;
+		darr_init(&other.d, element_size);
+	}
+
+	array &operator=(array &&other) noexcept
+	{
+		darr_swap(&d, &other.d);
+		return *this;
+	}
+
+	/*
+	 * Copying may fail so it is not done implicitly. Call assign instead.
+	 */
+	array(const array &) = delete;
+	array &operator=(const array &) = delete;
+
+	~array()
+	{
+		darr_deinit(&d);
+	}
+
+	/*
+	 * Replaces the elements with a copy of the elements of a view. The
+	 * array keeps its alignment and padding.
+	 *
+	 * Returns true on success, false on failure.
+	 *
+	 * On failure the array remains untouched.
+	 */
+	bool assign(struct darr_view v) noexcept
+	{
+		struct darr copy;
+
+		if (!darr_copy_view_aligned(&copy, v, d.alignment, d.padding)) {
+			return false;
+		}
+
+		darr_swap(&d, &copy);
+		darr_deinit(&copy);
+		return true;
+	}
+
+	/*
+	 * Replaces the elements with a copy of the elements of another array.
+	 */
+	bool assign(const array &other) noexcept
+	{
+		return assign(other.view());
+	}
+
+	/*
+	 * Returns the underlying struct darr so it can be passed to C code.
+	 */
+	struct darr *c_darr() noexcept
+	{
+		return &d;
+	}
+
+	const struct darr *c_darr() const noexcept
+	{
+		return &d;
+	}
+
+	/*
+	 * Gives up ownership of the elements and returns them in a struct darr
+	 * that must be deinitialized with darr_deinit. The array is left empty.
+	 */
+	struct darr release() noexcept
+	{
+		struct darr released = d;
+		darr_init(&d, element_size);
+		return released;
+	}
+
+	/*
+	 * Returns a view of a slice of the array.
+	 */
+	struct darr_view view(size_type start, size_type count) const noexcept
+	{
+		return darr_view_slice(&d, start, count);
+	}
+
+	/*
+	 * Returns a view of all elements of the array.
+	 */
+	struct darr_view view() const noexcept
+	{
+		return darr_view_all(&d);
+	}
+
+	size_type size() const noexcept
+	{
+		return darr_size(&d);
+	}
+
+	bool empty() const noexcept
+	{
+		return darr_empty(&d);
+	}
+
+	T *data() noexcept
+	{
+		return static_cast<T *>(darr_data(&d));
+	}
+
+	const T *data() const noexcept
+	{
+		return static_cast<const T *>(darr_data_const(&d));
+	}
+
+	T &operator[](size_type i) noexcept
+	{
+		return *static_cast<T *>(darr_element(&d, i));
+	}
+
+	const T &operator[](size_type i) const noexcept
+	{
+		return *static_cast<const T *>(darr_element_const(&d, i));
+	}
+
+	T &front() noexcept
+	{
+		return *static_cast<T *>(darr_first(&d));
+	}
+
+	const T &front() const noexcept
+	{
+		return *static_cast<const T *>(darr_first_const(&d));
+	}
+
+	T &back() noexcept
+	{
+		return *static_cast<T *>(darr_last(&d));
+	}
+
+	const T &back() const noexcept
+	{
+		return *static_cast<const T *>(darr_last_const(&d));
+	}
+
+	/*
+	 * Iterators are plain pointers so standard algorithms see the element
+	 * type and can be fully inlined.
+	 *
+	 * The restrictions for the pointers returned by darr_element apply.
+	 */
+	iterator begin() noexcept
+	{
+		return static_cast<T *>(darr_begin(&d));
+	}
+
+	const_iterator begin() const noexcept
+	{
+		return static_cast<const T *>(darr_begin_const(&d));
+	}
+
+	const_iterator cbegin() const noexcept
+	{
+		return begin();
+	}
+
+	iterator end() noexcept
+	{
+		return static_cast<T *>(darr_end(&d));
+	}
+
+	const_iterator end() const noexcept
+	{
+		return static_cast<const T *>(darr_end_const(&d));
+	}
+
+	const_iterator cend() const noexcept
+	{
+		return end();
+	}
+
+	reverse_iterator rbegin() noexcept
+	{
+		return reverse_iterator(end());
+	}
+
+	const_reverse_iterator rbegin() const noexcept
+	{
+		return const_reverse_iterator(end());
+	}
+
+	reverse_iterator rend() noexcept
+	{
+		return reverse_iterator(begin());
+	}
+
+	const_reverse_iterator rend() const noexcept
+	{
+		return const_reverse_iterator(begin());
+	}
+
+	/*
+	 * See darr_resize.
+	 */
+	bool resize(size_type size) noexcept
+	{
+		return darr_resize(&d, size);
+	}
+
+	/*
+	 * See darr_grow.
+	 */
+	bool grow(size_type size) noexcept
+	{
+		return darr_grow(&d, size);
+	}
+
+	/*
+	 * See darr_resize_zeroed.
+	 */
+	bool resize_zeroed(size_type size) noexcept
+	{
+		return darr_resize_zeroed(&d, size);
+	}
+
+	/*
+	 * See darr_grow_zeroed.
+	 */
+	bool grow_zeroed(size_type size) noexcept
+	{
+		return darr_grow_zeroed(&d, size);
+	}
+
+	/*
+	 * See darr_resize_fill. The value is taken by copy so it may be an
+	 * element of the array.
+	 */
+	bool resize_fill(size_type size, T value) noexcept
+	{
+		return darr_resize_fill(&d, size, &value);
+	}
+
+	/*
+	 * See darr_fill. The value is taken by copy so it may be an element of
+	 * the array.
+	 */
+	void fill(size_type start, size_type count, T value) noexcept
+	{
+		darr_fill(&d, start, count, &value);
+	}
+
+	/*
+	 * See darr_shrink.
+	 */
+	bool shrink(size_type size) noexcept
+	{
+		return darr_shrink(&d, size);
+	}
+
+	/*
+	 * See darr_truncate.
+	 */
+	void truncate(size_type size) noexcept
+	{
+		darr_truncate(&d, size);
+	}
+
+	/*
+	 * Adds a copy of an element to the end of the array. The value is taken
+	 * by copy so it may be an element of the array.
+	 *
+	 * Returns true on success, false on failure.
+	 */
+	bool push_back(T value) noexcept
+	{
+		if (!darr_grow(&d, 1)) {
+			return false;
+		}
+
+		back() = value;
+		return true;
+	}
+
+	/*
+	 * Removes the last element. The array may not be empty.
+	 */
+	bool pop_back() noexcept
+	{
+		return darr_shrink(&d, 1);
+	}
+
+	/*
+	 * See darr_insert_view. The view must hold elements of type T.
+	 */
+	bool insert(size_type i, struct darr_view v) noexcept
+	{
+		assert(v.element_size == element_size);
+		return darr_insert_view(&d, i, v);
+	}
+
+	/*
+	 * See darr_append_view. The view must hold elements of type T.
+	 */
+	bool append(struct darr_view v) noexcept
+	{
+		assert(v.element_size == element_size);
+		return darr_append_view(&d, v);
+	}
+
+	/*
+	 * See darr_prepend_view. The view must hold elements of type T.
+	 */
+	bool prepend(struct darr_view v) noexcept
+	{
+		assert(v.element_size == element_size);
+		return darr_prepend_view(&d, v);
+	}
+
+	/*
+	 * See darr_remove.
+	 */
+	bool remove(size_type start, size_type count) noexcept
+	{
+		return darr_remove(&d, start, count);
+	}
+
+	void swap(array &other) noexcept
+	{
+		darr_swap(&d, &other.d);
+	}
+
+private:
+	struct darr d;
+};
+
+template<typename T>
+constexpr typename darr::array<T>::size_type darr::array<T>::element_size;
+
+#endif /* DARR_DARR_HPP */
@@ -0,0 +1,235 @@
+#include "darr_bits.h"
+#include "darr_cpu.h"
+
+#ifdef DARR_CPU_X86
+#include <immintrin.h>
+#endif
+
+extern inline size_t darr_bits_word_count(size_t size);
+
+extern inline void darr_bits_init(struct darr_bits *b);
+
+extern inline void darr_bits_deinit(struct darr_bits *b);
+
+extern inline size_t darr_bits_size(const struct darr_bits *b);
+
+extern inline uint64_t *darr_bits_words(struct darr_bits *b);
+
+extern inline const uint64_t *darr_bits_words_const(const struct darr_bits *b);
+
+extern inline int darr_bits_resize(struct darr_bits *b, size_t size);
+
+extern inline int darr_bits_get(const struct darr_bits *b, size_t i);
+
+extern inline void darr_bits_set(struct darr_bits *b, size_t i);
+
+extern inline void darr_bits_clear(struct darr_bits *b, size_t i);
+
+extern inline void darr_bits_flip(struct darr_bits *b, size_t i);
+
+extern inline void darr_bits_put(struct darr_bits *b, size_t i, int value);
+
+extern inline int darr_bits_push(struct darr_bits *b, int value);
+
+extern inline void darr_bits_clear_all(struct darr_bits *b);
+
+extern inline void darr_bits_set_all(struct darr_bits *b);
+
+extern inline size_t darr_bits_find_first(const struct darr_bits *b);
+
+/*
+ * The combining functions process 4 words at a time with AVX2 when the CPU
+ * supports it and finish off one word at a time.
+ *
+ * Inside the loops x and y point to the words of both arrays, vx and vy hold
+ * 4 words of each, n is the number of words and i is the index of the
+ * current word.
+ */
+#ifdef DARR_CPU_X86
+#define DARR_BITS_COMBINE_AVX2(name, scalar, vector) \
+	DARR_CPU_TARGET("avx2") \
+	static void name##_avx2(uint64_t *x, const uint64_t *y, size_t n) \
+	{ \
+		size_t i = 0; \
+		for (; i + 4 <= n; i += 4) { \
+			__m256i vx = _mm256_loadu_si256((const __m256i *) (x + i)); \
+			__m256i vy = _mm256_loadu_si256((const __m256i *) (y + i)); \
+			_mm256_storeu_si256((__m256i *) (x + i), vector); \
+		} \
+		for (; i < n; ++i) { \
+			x[i] = scalar; \
+		} \
+	}
+#define DARR_BITS_AVX2(name) name##_avx2
+#else
+#define DARR_BITS_COMBINE_AVX2(name, scalar, vector)
+#define DARR_BITS_AVX2(name) name##_scalar
+#endif
+
+#define DARR_BITS_COMBINE(name, scalar, vector) \
+	static void name##_scalar(uint64_t *x, const uint64_t *y, size_t n) \
+	{ \
+		for (size_t i = 0; i < n; ++i) { \
+			x[i] = scalar; \
+		} \
+	} \
+	DARR_BITS_COMBINE_AVX2(name, scalar, vector) \
+	static void (*const name##_kernels[DARR_CPU_LEVELS])( \
+		uint64_t *, \
+		const uint64_t *, \
+		size_t) = { \
+		name##_scalar, \
+		name##_scalar, \
+		name##_scalar, \
+		DARR_BITS_AVX2(name), \
+	}; \
+	void name(struct darr_bits *b, const struct darr_bits *other) \
+	{ \
+		name##_kernels[darr_cpu_active]( \
+			darr_bits_words(b), \
+			darr_bits_words_const(other), \
+			darr_size(&b->words)); \
+	}
+
+DARR_BITS_COMBINE(darr_bits_and, x[i] & y[i], _mm256_and_si256(vx, vy))
+
+DARR_BITS_COMBINE(darr_bits_or, x[i] | y[i], _mm256_or_si256(vx, vy))
+
+DARR_BITS_COMBINE(darr_bits_xor, x[i] ^ y[i], _mm256_xor_si256(vx, vy))
+
+DARR_BITS_COMBINE(darr_bits_andnot, x[i] & ~y[i], _mm256_andnot_si256(vy, vx))
+
+static size_t darr_bits_popcount_scalar(const uint64_t *w, size_t n)
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		count += __builtin_popcountll(w[i]);
+	}
+
+	return count;
+}
+
+#ifdef DARR_CPU_X86
+DARR_CPU_TARGET("avx2")
+static size_t darr_bits_popcount_avx2(const uint64_t *w, size_t n)
+{
+	size_t count = 0;
+	size_t i = 0;
+
+	// Counts the bits of each nibble with a lookup table and adds up the
+	// bytes of every 64 bit lane with a sum of absolute differences.
+	const __m256i lookup = _mm256_setr_epi8(
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_mask = _mm256_set1_epi8(0x0f);
+	__m256i total = _mm256_setzero_si256();
+
+	for (; i + 4 <= n; i += 4) {
+		__m256i v = _mm256_loadu_si256((const __m256i *) (w + i));
+		__m256i lo = _mm256_and_si256(v, low_mask);
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+		__m256i bytes = _mm256_add_epi8(
+			_mm256_shuffle_epi8(lookup, lo),
+			_mm256_shuffle_epi8(lookup, hi));
+
+		total = _mm256_add_epi64(
+			total,
+			_mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+	}
+
+	count += _mm256_extract_epi64(total, 0);
+	count += _mm256_extract_epi64(total, 1);
+	count += _mm256_extract_epi64(total, 2);
+	count += _mm256_extract_epi64(total, 3);
+
+	for (; i < n; ++i) {
+		count += __builtin_popcountll(w[i]);
+	}
+
+	return count;
+}
+#endif
+
+static size_t (*const darr_bits_popcount_kernels[DARR_CPU_LEVELS])(
+	const uint64_t *,
+	size_t) = {
+	darr_bits_popcount_scalar,
+	darr_bits_popcount_scalar,
+	darr_bits_popcount_scalar,
+	DARR_BITS_AVX2(darr_bits_popcount),
+};
+
+size_t darr_bits_popcount(const struct darr_bits *b)
+{
+	return darr_bits_popcount_kernels[darr_cpu_active](
+		darr_bits_words_const(b),
+		darr_size(&b->words));
+}
+
+/*
+ * Returns the index of the first word from i on that is not zero, or n if
+ * there is none.
+ */
+static size_t darr_bits_skip_zero_scalar(const uint64_t *w, size_t i, size_t n)
+{
+	while (i < n && w[i] == 0) {
+		i += 1;
+	}
+
+	return i;
+}
+
+#ifdef DARR_CPU_X86
+DARR_CPU_TARGET("avx2")
+static size_t darr_bits_skip_zero_avx2(const uint64_t *w, size_t i, size_t n)
+{
+	// Skips over runs of zero words 4 at a time.
+	while (i + 4 <= n) {
+		__m256i v = _mm256_loadu_si256((const __m256i *) (w + i));
+
+		if (!_mm256_testz_si256(v, v)) {
+			break;
+		}
+
+		i += 4;
+	}
+
+	return darr_bits_skip_zero_scalar(w, i, n);
+}
+#endif
+
+static size_t (*const darr_bits_skip_zero_kernels[DARR_CPU_LEVELS])(
+	const uint64_t *,
+	size_t,
+	size_t) = {
+	darr_bits_skip_zero_scalar,
+	darr_bits_skip_zero_scalar,
+	darr_bits_skip_zero_scalar,
+	DARR_BITS_AVX2(darr_bits_skip_zero),
+};
+
+size_t darr_bits_next(const struct darr_bits *b, size_t from)
+{
+	if (from >= b->size) {
+		return b->size;
+	}
+
+	const uint64_t *w = darr_bits_words_const(b);
+	size_t n = darr_size(&b->words);
+	size_t i = from / 64;
+	uint64_t word = w[i] & (~UINT64_C(0) << (from % 64));
+
+	if (word == 0) {
+		i = darr_bits_skip_zero_kernels[darr_cpu_active](w, i + 1, n);
+
+		if (i == n) {
+			return b->size;
+		}
+
+		word = w[i];
+	}
+
+	// Bits past the size are always zero so the result is in bounds.
+	return i * 64 + __builtin_ctzll(word);
+}
@@ -0,0 +1,253 @@
+#ifndef DARR_DARR_BITS_H
+#define DARR_DARR_BITS_H
+
+#include <stdint.h>
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A resizable array of bits. Takes one bit of memory per element instead of
+ * the one byte that is the smallest element size of struct darr.
+ *
+ * Bits are stored in 64 bit words. Bit i lives in word i / 64 at position
+ * i % 64. Bits past the size in the last word are always zero.
+ *
+ * You can initialize it by calling darr_bits_init.
+ */
+struct darr_bits {
+	size_t size;
+	struct darr words;
+};
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Returns the number of words needed to store the given number of bits.
+ */
+inline size_t darr_bits_word_count(size_t size)
+{
+	return (size + 63) / 64;
+}
+
+/*
+ * Initializes a darr_bits struct.
+ *
+ * Call darr_bits_deinit to deinitialize.
+ */
+inline void darr_bits_init(struct darr_bits *b)
+{
+	b->size = 0;
+	darr_init(&b->words, sizeof(uint64_t));
+}
+
+/*
+ * Deinitializes a darr_bits struct.
+ */
+inline void darr_bits_deinit(struct darr_bits *b)
+{
+	darr_deinit(&b->words);
+}
+
+/*
+ * Returns the number of bits.
+ */
+inline size_t darr_bits_size(const struct darr_bits *b)
+{
+	return b->size;
+}
+
+/*
+ * Returns a pointer to the words that store the bits.
+ *
+ * The restrictions for the pointers returned by darr_element apply.
+ */
+inline uint64_t *darr_bits_words(struct darr_bits *b)
+{
+	return (uint64_t *) darr_data(&b->words);
+}
+
+/*
+ * Like darr_bits_words, but returns a const pointer.
+ */
+inline const uint64_t *darr_bits_words_const(const struct darr_bits *b)
+{
+	return darr_bits_words((struct darr_bits *) b);
+}
+
+/*
+ * Changes the number of bits. New bits are zero.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the size and the contents of the array remain untouched.
+ */
+inline int darr_bits_resize(struct darr_bits *b, size_t size)
+{
+	size_t old_words = darr_size(&b->words);
+	size_t new_words = darr_bits_word_count(size);
+
+	if (!darr_resize(&b->words, new_words)) {
+		return 0;
+	}
+
+	uint64_t *words = darr_bits_words(b);
+
+	if (new_words > old_words) {
+		memset(
+			words + old_words,
+			0,
+			(new_words - old_words) * sizeof(uint64_t));
+	}
+
+	if (size < b->size && size % 64 != 0) {
+		words[size / 64] &= (UINT64_C(1) << (size % 64)) - 1;
+	}
+
+	b->size = size;
+	return 1;
+}
+
+/*
+ * Returns the value of a bit, either 0 or 1.
+ */
+inline int darr_bits_get(const struct darr_bits *b, size_t i)
+{
+	return (darr_bits_words_const(b)[i / 64] >> (i % 64)) & 1;
+}
+
+/*
+ * Sets a bit to 1.
+ */
+inline void darr_bits_set(struct darr_bits *b, size_t i)
+{
+	darr_bits_words(b)[i / 64] |= UINT64_C(1) << (i % 64);
+}
+
+/*
+ * Sets a bit to 0.
+ */
+inline void darr_bits_clear(struct darr_bits *b, size_t i)
+{
+	darr_bits_words(b)[i / 64] &= ~(UINT64_C(1) << (i % 64));
+}
+
+/*
+ * Inverts a bit.
+ */
+inline void darr_bits_flip(struct darr_bits *b, size_t i)
+{
+	darr_bits_words(b)[i / 64] ^= UINT64_C(1) << (i % 64);
+}
+
+/*
+ * Sets a bit to 1 if value is not zero, otherwise sets it to 0.
+ */
+inline void darr_bits_put(struct darr_bits *b, size_t i, int value)
+{
+	if (value) {
+		darr_bits_set(b, i);
+	} else {
+		darr_bits_clear(b, i);
+	}
+}
+
+/*
+ * Adds a bit to the end.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+inline int darr_bits_push(struct darr_bits *b, int value)
+{
+	if (!darr_bits_resize(b, b->size + 1)) {
+		return 0;
+	}
+
+	darr_bits_put(b, b->size - 1, value);
+	return 1;
+}
+
+/*
+ * Sets every bit to 0.
+ */
+inline void darr_bits_clear_all(struct darr_bits *b)
+{
+	memset(darr_bits_words(b), 0, darr_size(&b->words) * sizeof(uint64_t));
+}
+
+/*
+ * Sets every bit to 1.
+ */
+inline void darr_bits_set_all(struct darr_bits *b)
+{
+	memset(darr_bits_words(b), 0xff, darr_size(&b->words) * sizeof(uint64_t));
+
+	if (b->size % 64 != 0) {
+		darr_bits_words(b)[b->size / 64] =
+			(UINT64_C(1) << (b->size % 64)) - 1;
+	}
+}
+
+/*
+ * The following functions combine two arrays of bits bit by bit and store
+ * the result in the first one. Both arrays must have the same size.
+ */
+
+/*
+ * b = b & other
+ */
+void darr_bits_and(struct darr_bits *b, const struct darr_bits *other);
+
+/*
+ * b = b | other
+ */
+void darr_bits_or(struct darr_bits *b, const struct darr_bits *other);
+
+/*
+ * b = b ^ other
+ */
+void darr_bits_xor(struct darr_bits *b, const struct darr_bits *other);
+
+/*
+ * b = b & ~other
+ */
+void darr_bits_andnot(struct darr_bits *b, const struct darr_bits *other);
+
+/*
+ * Returns the number of bits that are set to 1.
+ */
+size_t darr_bits_popcount(const struct darr_bits *b);
+
+/*
+ * Returns the index of the first bit set to 1 at or after the given index.
+ *
+ * If there is none, returns the size of the array.
+ *
+ * You can iterate over every bit set to 1 like this:
+ *
+ *	for (size_t i = darr_bits_next(b, 0);
+ *		i < darr_bits_size(b);
+ *		i = darr_bits_next(b, i + 1)) {
+ *		[...]
+ *	}
+ */
+size_t darr_bits_next(const struct darr_bits *b, size_t from);
+
+/*
+ * Returns the index of the first bit set to 1.
+ *
+ * If there is none, returns the size of the array.
+ */
+inline size_t darr_bits_find_first(const struct darr_bits *b)
+{
+	return darr_bits_next(b, 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_BITS_H */
@@ -0,0 +1,68 @@
+#include "darr_cpu.h"
+
+DARR_GLOBAL enum darr_cpu_level darr_cpu_active = DARR_CPU_SCALAR;
+
+#ifndef DARR_HEADER_ONLY
+extern inline enum darr_cpu_level darr_cpu_level(void);
+#endif
+
+DARR_API enum darr_cpu_level darr_cpu_detect(void)
+{
+#ifdef DARR_CPU_X86
+	__builtin_cpu_init();
+
+	// These also check that the operating system saves the registers.
+	if (__builtin_cpu_supports("avx2")) {
+		return DARR_CPU_AVX2;
+	}
+
+	if (__builtin_cpu_supports("ssse3")) {
+		return DARR_CPU_SSSE3;
+	}
+
+	if (__builtin_cpu_supports("sse2")) {
+		return DARR_CPU_SSE2;
+	}
+#endif
+
+	return DARR_CPU_SCALAR;
+}
+
+DARR_API int darr_cpu_level_set(enum darr_cpu_level level)
+{
+	if (level >= DARR_CPU_LEVELS || level > darr_cpu_detect()) {
+		return 0;
+	}
+
+	darr_cpu_active = level;
+	return 1;
+}
+
+DARR_API const char *darr_cpu_level_name(enum darr_cpu_level level)
+{
+	static const char *const names[DARR_CPU_LEVELS] = {
+		"SCALAR",
+		"SSE2",
+		"SSSE3",
+		"AVX2",
+	};
+
+	return level < DARR_CPU_LEVELS ? names[level] : "UNKNOWN";
+}
+
+/*
+ * Picks the level before main runs so that kernels never have to check
+ * whether it was picked. The compilers that support constructors are the
+ * same ones that have kernels for more than one level.
+ */
+#ifdef DARR_CPU_X86
+__attribute__((constructor))
+static void darr_cpu_init(void)
+{
+#ifdef DARR_CPU_FORCE
+	darr_cpu_active = DARR_CPU_FORCE;
+#else
+	darr_cpu_active = darr_cpu_detect();
+#endif
+}
+#endif
@@ -0,0 +1,107 @@
+/*
+ * darr.h comes before the include guard because in header only mode it
+ * includes darr.c, which needs the declarations below. If this file was
+ * included first they would not be there yet.
+ */
+#include "darr.h"
+
+#ifndef DARR_DARR_CPU_H
+#define DARR_DARR_CPU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The instruction set levels darr has kernels for, from slowest to fastest.
+ * Every level includes the ones before it.
+ *
+ * The SIMD kernels of darr are compiled for every level regardless of the
+ * flags the library is built with and the level that is used is picked when
+ * the program is loaded, by asking the CPU what it supports. This lets one
+ * binary run at full speed on different machines.
+ *
+ * The kernels that are picked this way are those of darr_fill,
+ * darr_data_move_stream, the intersections of darr_set, the combining
+ * functions, darr_bits_popcount and darr_bits_next of darr_bits, and the
+ * packing and unpacking of the blocks of darr_packed.
+ *
+ * The rest of the vector code in darr is still compiled for the level the
+ * compiler targets. The group matching of darr_hindex is too small to be
+ * called through a table and needs no more than SSE2, which every x86-64 CPU
+ * has.
+ *
+ * Building with the CMake option DARR_CPU_LEVEL set to one of SCALAR, SSE2,
+ * SSSE3 or AVX2 makes the library start with that level instead. A level
+ * the CPU does not support crashes the program on the first kernel that
+ * uses an instruction it lacks.
+ *
+ * Outside of x86 or with compilers other than GCC and Clang only the scalar
+ * kernels are compiled.
+ */
+enum darr_cpu_level {
+	DARR_CPU_SCALAR,
+	DARR_CPU_SSE2,
+	DARR_CPU_SSSE3,
+	DARR_CPU_AVX2,
+	DARR_CPU_LEVELS,
+};
+
+/*
+ * This is an implementation detail. Don't use these macros.
+ *
+ * DARR_CPU_X86 is defined when kernels for x86 levels are compiled and
+ * DARR_CPU_TARGET marks a function as one that may use the instructions of
+ * the given level, like the -m flags of the compiler do for a whole file.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) \
+	&& (defined(__x86_64__) || defined(__i386__))
+#define DARR_CPU_X86
+#define DARR_CPU_TARGET(level) __attribute__((target(level)))
+#endif
+
+/*
+ * This is an implementation detail. Don't use this variable.
+ *
+ * The level in use. Modules index their tables of kernels with it.
+ */
+DARR_EXTERN enum darr_cpu_level darr_cpu_active;
+
+/*
+ * Returns the highest level the CPU supports.
+ */
+DARR_API enum darr_cpu_level darr_cpu_detect(void);
+
+/*
+ * Returns the level in use.
+ */
+DARR_INLINE enum darr_cpu_level darr_cpu_level(void)
+{
+	return darr_cpu_active;
+}
+
+/*
+ * Changes the level in use. Meant for tests and benchmarks that compare
+ * kernels, it must not be called while other threads are calling darr.
+ *
+ * Returns 1 on success, 0 if the CPU does not support the level or there
+ * are no kernels for it on this platform.
+ *
+ * On failure the level remains untouched.
+ */
+DARR_API int darr_cpu_level_set(enum darr_cpu_level level);
+
+/*
+ * Returns the name of a level, as accepted by the DARR_CPU_LEVEL option.
+ */
+DARR_API const char *darr_cpu_level_name(enum darr_cpu_level level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef DARR_HEADER_ONLY
+#include "darr_cpu.c"
+#endif
+
+#endif /* DARR_DARR_CPU_H */
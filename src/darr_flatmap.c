@@ -0,0 +1,346 @@
+#include "darr_flatmap.h"
+
+extern inline void darr_flatmap_init(
+	struct darr_flatmap *m,
+	size_t key_size,
+	size_t value_size,
+	darr_flatmap_compare_t compare);
+
+extern inline void darr_flatmap_deinit(struct darr_flatmap *m);
+
+extern inline size_t darr_flatmap_size(const struct darr_flatmap *m);
+
+extern inline const void *darr_flatmap_key(
+	const struct darr_flatmap *m,
+	size_t i);
+
+extern inline void *darr_flatmap_value(struct darr_flatmap *m, size_t i);
+
+extern inline struct darr_view darr_flatmap_keys(const struct darr_flatmap *m);
+
+extern inline struct darr_view darr_flatmap_values(
+	const struct darr_flatmap *m);
+
+extern inline size_t darr_flatmap_find(
+	const struct darr_flatmap *m,
+	const void *key);
+
+extern inline void *darr_flatmap_get(struct darr_flatmap *m, const void *key);
+
+extern inline int darr_flatmap_erase(struct darr_flatmap *m, const void *key);
+
+/*
+ * Sets have no values so their value array is never resized.
+ */
+static int darr_flatmap_is_set(const struct darr_flatmap *m)
+{
+	return m->values.element_size == 0;
+}
+
+size_t darr_flatmap_lower_bound(const struct darr_flatmap *m, const void *key)
+{
+	size_t first = 0;
+	size_t count = darr_flatmap_size(m);
+
+	while (count > 0) {
+		size_t step = count / 2;
+		size_t i = first + step;
+
+		if (m->compare(darr_flatmap_key(m, i), key) < 0) {
+			first = i + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+
+	return first;
+}
+
+int darr_flatmap_insert(
+	struct darr_flatmap *m,
+	const void *key,
+	const void *value)
+{
+	size_t i = darr_flatmap_lower_bound(m, key);
+	size_t value_size = m->values.element_size;
+
+	if (i < darr_flatmap_size(m)
+		&& m->compare(darr_flatmap_key(m, i), key) == 0) {
+		if (!darr_flatmap_is_set(m)) {
+			memcpy(darr_flatmap_value(m, i), value, value_size);
+		}
+
+		return 1;
+	}
+
+	struct darr_view k = darr_view_from(key, 1, m->keys.element_size);
+
+	if (!darr_insert_view(&m->keys, i, k)) {
+		return 0;
+	}
+
+	if (!darr_flatmap_is_set(m)) {
+		struct darr_view v = darr_view_from(value, 1, value_size);
+
+		if (!darr_insert_view(&m->values, i, v)) {
+			darr_remove(&m->keys, i, 1);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Removes an element from one of the arrays of a map. Unlike darr_remove
+ * this cannot fail, which keeps keys and values in step.
+ */
+static void darr_flatmap_remove(struct darr *d, size_t i)
+{
+	darr_shift_slice_left(d, 1, i, darr_size(d) - i);
+	darr_truncate(d, darr_size(d) - 1);
+}
+
+int darr_flatmap_erase_at(struct darr_flatmap *m, size_t i)
+{
+	darr_flatmap_remove(&m->keys, i);
+
+	if (!darr_flatmap_is_set(m)) {
+		darr_flatmap_remove(&m->values, i);
+	}
+
+	return 1;
+}
+
+/*
+ * Sorts the positions of the keys in order by key with a stable bottom-up
+ * merge sort. tmp is scratch space of the same size as order.
+ */
+static void darr_flatmap_sort(
+	darr_flatmap_compare_t compare,
+	struct darr_view keys,
+	struct darr *order,
+	struct darr *tmp)
+{
+	size_t n = darr_view_size(keys);
+
+	for (size_t width = 1; width < n; width *= 2) {
+		const size_t *src = (const size_t *) darr_data(order);
+		size_t *dst = (size_t *) darr_data(tmp);
+
+		for (size_t lo = 0; lo < n; lo += 2 * width) {
+			size_t mid = lo + width < n ? lo + width : n;
+			size_t hi = lo + 2 * width < n ? lo + 2 * width : n;
+			size_t i = lo;
+			size_t j = mid;
+			size_t k = lo;
+
+			while (i < mid && j < hi) {
+				const void *a = darr_view_element(keys, src[i]);
+				const void *b = darr_view_element(keys, src[j]);
+
+				// Taking from the left run on ties keeps the
+				// sort stable.
+				if (compare(b, a) < 0) {
+					dst[k++] = src[j++];
+				} else {
+					dst[k++] = src[i++];
+				}
+			}
+
+			while (i < mid) {
+				dst[k++] = src[i++];
+			}
+
+			while (j < hi) {
+				dst[k++] = src[j++];
+			}
+		}
+
+		darr_swap(order, tmp);
+	}
+}
+
+/*
+ * Initializes the arrays that will hold the entries of a map while it is
+ * being rebuilt.
+ */
+static int darr_flatmap_prepare(
+	const struct darr_flatmap *m,
+	struct darr *keys,
+	struct darr *values,
+	size_t size)
+{
+	darr_init(keys, m->keys.element_size);
+	darr_init(values, m->values.element_size);
+
+	if (!darr_resize(keys, size)) {
+		return 0;
+	}
+
+	if (!darr_flatmap_is_set(m) && !darr_resize(values, size)) {
+		darr_deinit(keys);
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Trims the arrays filled by a rebuild to their final size and puts them in
+ * place of the entries of the map.
+ */
+static void darr_flatmap_commit(
+	struct darr_flatmap *m,
+	struct darr *keys,
+	struct darr *values,
+	size_t size)
+{
+	darr_truncate(keys, size);
+
+	if (!darr_flatmap_is_set(m)) {
+		darr_truncate(values, size);
+	}
+
+	darr_swap(&m->keys, keys);
+	darr_swap(&m->values, values);
+	darr_deinit(keys);
+	darr_deinit(values);
+}
+
+int darr_flatmap_build(
+	struct darr_flatmap *m,
+	struct darr_view keys,
+	struct darr_view values)
+{
+	size_t n = darr_view_size(keys);
+	size_t key_size = m->keys.element_size;
+	size_t value_size = m->values.element_size;
+
+	struct darr order;
+	struct darr tmp;
+	darr_init(&order, sizeof(size_t));
+	darr_init(&tmp, sizeof(size_t));
+
+	if (!darr_resize(&order, n) || !darr_resize(&tmp, n)) {
+		darr_deinit(&order);
+		darr_deinit(&tmp);
+		return 0;
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		((size_t *) darr_data(&order))[i] = i;
+	}
+
+	darr_flatmap_sort(m->compare, keys, &order, &tmp);
+	darr_deinit(&tmp);
+
+	struct darr new_keys;
+	struct darr new_values;
+
+	if (!darr_flatmap_prepare(m, &new_keys, &new_values, n)) {
+		darr_deinit(&order);
+		return 0;
+	}
+
+	const size_t *sorted = (const size_t *) darr_data(&order);
+	size_t count = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		const void *key = darr_view_element(keys, sorted[i]);
+
+		// Of a run of equal keys only the last one, which came last in
+		// the input, is kept.
+		if (i + 1 < n
+			&& m->compare(darr_view_element(keys, sorted[i + 1]), key)
+				== 0) {
+			continue;
+		}
+
+		memcpy(darr_element(&new_keys, count), key, key_size);
+
+		if (!darr_flatmap_is_set(m)) {
+			memcpy(
+				darr_element(&new_values, count),
+				darr_view_element(values, sorted[i]),
+				value_size);
+		}
+
+		count += 1;
+	}
+
+	darr_deinit(&order);
+	darr_flatmap_commit(m, &new_keys, &new_values, count);
+	return 1;
+}
+
+/*
+ * Copies entry i of a map to position n of the arrays of a rebuild.
+ */
+static void darr_flatmap_copy_entry(
+	struct darr *keys,
+	struct darr *values,
+	size_t n,
+	const struct darr_flatmap *src,
+	size_t i)
+{
+	memcpy(
+		darr_element(keys, n),
+		darr_flatmap_key(src, i),
+		keys->element_size);
+
+	if (!darr_flatmap_is_set(src)) {
+		memcpy(
+			darr_element(values, n),
+			darr_element_const(&src->values, i),
+			values->element_size);
+	}
+}
+
+int darr_flatmap_merge(
+	struct darr_flatmap *m,
+	const struct darr_flatmap *a,
+	const struct darr_flatmap *b)
+{
+	size_t na = darr_flatmap_size(a);
+	size_t nb = darr_flatmap_size(b);
+
+	struct darr keys;
+	struct darr values;
+
+	if (!darr_flatmap_prepare(m, &keys, &values, na + nb)) {
+		return 0;
+	}
+
+	size_t i = 0;
+	size_t j = 0;
+	size_t n = 0;
+
+	while (i < na && j < nb) {
+		int order = m->compare(
+			darr_flatmap_key(a, i),
+			darr_flatmap_key(b, j));
+
+		if (order < 0) {
+			darr_flatmap_copy_entry(&keys, &values, n++, a, i++);
+		} else {
+			if (order == 0) {
+				i += 1;
+			}
+
+			darr_flatmap_copy_entry(&keys, &values, n++, b, j++);
+		}
+	}
+
+	while (i < na) {
+		darr_flatmap_copy_entry(&keys, &values, n++, a, i++);
+	}
+
+	while (j < nb) {
+		darr_flatmap_copy_entry(&keys, &values, n++, b, j++);
+	}
+
+	darr_flatmap_commit(m, &keys, &values, n);
+	return 1;
+}
@@ -0,0 +1,218 @@
+#ifndef DARR_DARR_FLATMAP_H
+#define DARR_DARR_FLATMAP_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compares two keys. Must return a negative number if the first key comes
+ * before the second one, a positive number if it comes after and zero if
+ * they are equal. This is the same contract as the comparison function of
+ * qsort.
+ */
+typedef int (*darr_flatmap_compare_t)(const void *, const void *);
+
+/*
+ * A map kept as sorted arrays. Keys and values are stored in separate arrays
+ * so that searching only reads keys.
+ *
+ * Lookups are binary searches. Insertions and removals shift the elements
+ * that come after the position they change, which for small and medium sized
+ * maps is usually cheaper than maintaining a tree.
+ *
+ * A map whose values have a size of zero is a set.
+ *
+ * You can initialize it by calling darr_flatmap_init.
+ */
+struct darr_flatmap {
+	darr_flatmap_compare_t compare;
+	struct darr keys;
+	struct darr values;
+};
+
+/*
+ * Initializes an empty darr_flatmap struct.
+ *
+ * Call darr_flatmap_deinit to deinitialize.
+ */
+inline void darr_flatmap_init(
+	struct darr_flatmap *m,
+	size_t key_size,
+	size_t value_size,
+	darr_flatmap_compare_t compare)
+{
+	m->compare = compare;
+	darr_init(&m->keys, key_size);
+	darr_init(&m->values, value_size);
+}
+
+/*
+ * Deinitializes a darr_flatmap struct.
+ */
+inline void darr_flatmap_deinit(struct darr_flatmap *m)
+{
+	darr_deinit(&m->keys);
+	darr_deinit(&m->values);
+}
+
+/*
+ * Returns the number of entries.
+ */
+inline size_t darr_flatmap_size(const struct darr_flatmap *m)
+{
+	return darr_size(&m->keys);
+}
+
+/*
+ * Returns a pointer to the key of the entry at the given position. Entries
+ * are sorted by key.
+ *
+ * The restrictions for the pointers returned by darr_element apply.
+ */
+inline const void *darr_flatmap_key(const struct darr_flatmap *m, size_t i)
+{
+	return darr_element_const(&m->keys, i);
+}
+
+/*
+ * Returns a pointer to the value of the entry at the given position.
+ *
+ * The restrictions for the pointers returned by darr_element apply.
+ */
+inline void *darr_flatmap_value(struct darr_flatmap *m, size_t i)
+{
+	return darr_element(&m->values, i);
+}
+
+/*
+ * Returns a view of the keys, in sorted order.
+ */
+inline struct darr_view darr_flatmap_keys(const struct darr_flatmap *m)
+{
+	return darr_view_all(&m->keys);
+}
+
+/*
+ * Returns a view of the values, in the order of their keys.
+ */
+inline struct darr_view darr_flatmap_values(const struct darr_flatmap *m)
+{
+	return darr_view_all(&m->values);
+}
+
+/*
+ * Returns the position of the first entry whose key does not come before the
+ * given key. If there is none, returns the size of the map.
+ */
+size_t darr_flatmap_lower_bound(const struct darr_flatmap *m, const void *key);
+
+/*
+ * Returns the position of the entry with the given key. If there is none,
+ * returns the size of the map.
+ */
+inline size_t darr_flatmap_find(const struct darr_flatmap *m, const void *key)
+{
+	size_t i = darr_flatmap_lower_bound(m, key);
+
+	if (i < darr_flatmap_size(m)
+		&& m->compare(darr_flatmap_key(m, i), key) == 0) {
+		return i;
+	}
+
+	return darr_flatmap_size(m);
+}
+
+/*
+ * Returns a pointer to the value of the entry with the given key or NULL if
+ * there is none.
+ *
+ * The restrictions for the pointers returned by darr_element apply.
+ */
+inline void *darr_flatmap_get(struct darr_flatmap *m, const void *key)
+{
+	size_t i = darr_flatmap_find(m, key);
+
+	if (i == darr_flatmap_size(m)) {
+		return NULL;
+	}
+
+	return darr_flatmap_value(m, i);
+}
+
+/*
+ * Inserts an entry or, if the key is already present, replaces its value.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the map remains untouched.
+ */
+int darr_flatmap_insert(
+	struct darr_flatmap *m,
+	const void *key,
+	const void *value);
+
+/*
+ * Removes the entry at the given position.
+ *
+ * Always returns 1. Removing an entry cannot fail.
+ */
+int darr_flatmap_erase_at(struct darr_flatmap *m, size_t i);
+
+/*
+ * Removes the entry with the given key, if there is one.
+ *
+ * Always returns 1. Removing an entry cannot fail.
+ */
+inline int darr_flatmap_erase(struct darr_flatmap *m, const void *key)
+{
+	size_t i = darr_flatmap_find(m, key);
+
+	if (i == darr_flatmap_size(m)) {
+		return 1;
+	}
+
+	return darr_flatmap_erase_at(m, i);
+}
+
+/*
+ * Replaces the entries with the given keys and values, which do not need to
+ * be sorted. The values view must have as many elements as the keys view,
+ * unless the map is a set, in which case it is ignored.
+ *
+ * The keys are sorted with a stable merge sort and duplicates are dropped in
+ * the same pass that copies the entries into place. When a key appears more
+ * than once, the value that comes last wins.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the map remains untouched.
+ */
+int darr_flatmap_build(
+	struct darr_flatmap *m,
+	struct darr_view keys,
+	struct darr_view values);
+
+/*
+ * Replaces the entries of m with the union of the entries of a and b in
+ * linear time. When a key is present in both, the value of b wins.
+ *
+ * All three maps must have the same key and value sizes and comparison
+ * function, and m may not be a or b.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure m remains untouched.
+ */
+int darr_flatmap_merge(
+	struct darr_flatmap *m,
+	const struct darr_flatmap *a,
+	const struct darr_flatmap *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_FLATMAP_H */
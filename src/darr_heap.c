@@ -0,0 +1,216 @@
+#include "darr_heap.h"
+
+/*
+ * Elements up to this size are held in a buffer on the stack while they are
+ * being sifted. Larger ones are held in a buffer from darr_realloc.
+ */
+#define DARR_HEAP_STACK_SIZE 64
+
+struct darr_heap_temp {
+	union {
+		max_align_t align;
+		unsigned char bytes[DARR_HEAP_STACK_SIZE];
+	} stack;
+	void *data;
+};
+
+static int darr_heap_temp_init(struct darr_heap_temp *t, size_t size)
+{
+	if (size <= sizeof(t->stack)) {
+		t->data = t->stack.bytes;
+		return 1;
+	}
+
+	t->data = darr_mem_realloc(NULL, size);
+	return t->data != NULL;
+}
+
+static void darr_heap_temp_deinit(struct darr_heap_temp *t)
+{
+	if (t->data != t->stack.bytes) {
+		darr_mem_free(t->data);
+	}
+}
+
+/*
+ * Moves the hole at index i up, moving parents that come after e into it,
+ * and stores e where the hole ends up.
+ */
+static void darr_heap_sift_up(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	size_t i,
+	const void *e)
+{
+	while (i > 0) {
+		size_t parent = (i - 1) / arity;
+		const void *p = darr_element(d, parent);
+
+		if (compare(e, p) >= 0) {
+			break;
+		}
+
+		memcpy(darr_element(d, i), p, d->element_size);
+		i = parent;
+	}
+
+	memcpy(darr_element(d, i), e, d->element_size);
+}
+
+/*
+ * Moves the hole at index i down among the first n elements, moving the
+ * child that comes first into it while that child comes before e, and stores
+ * e where the hole ends up.
+ */
+static void darr_heap_sift_down(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	size_t i,
+	size_t n,
+	const void *e)
+{
+	for (;;) {
+		size_t first = i * arity + 1;
+
+		if (first >= n) {
+			break;
+		}
+
+		size_t last = n - first > arity ? first + arity : n;
+		size_t best = first;
+		const void *b = darr_element(d, best);
+
+		for (size_t c = first + 1; c < last; ++c) {
+			const void *x = darr_element(d, c);
+
+			if (compare(x, b) < 0) {
+				best = c;
+				b = x;
+			}
+		}
+
+		if (compare(b, e) >= 0) {
+			break;
+		}
+
+		memcpy(darr_element(d, i), b, d->element_size);
+		i = best;
+	}
+
+	memcpy(darr_element(d, i), e, d->element_size);
+}
+
+int darr_heapify(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare)
+{
+	size_t n = darr_size(d);
+
+	if (n < 2) {
+		return 1;
+	}
+
+	struct darr_heap_temp temp;
+
+	if (!darr_heap_temp_init(&temp, d->element_size)) {
+		return 0;
+	}
+
+	// Sifts down every element that has children, starting from the last.
+	for (size_t i = (n - 2) / arity + 1; i-- > 0;) {
+		memcpy(temp.data, darr_element(d, i), d->element_size);
+		darr_heap_sift_down(d, arity, compare, i, n, temp.data);
+	}
+
+	darr_heap_temp_deinit(&temp);
+	return 1;
+}
+
+int darr_heap_push(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	const void *e)
+{
+	if (!darr_grow(d, 1)) {
+		return 0;
+	}
+
+	darr_heap_sift_up(d, arity, compare, darr_size(d) - 1, e);
+	return 1;
+}
+
+int darr_heap_pop(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	void *e)
+{
+	if (darr_empty(d)) {
+		return 0;
+	}
+
+	if (e != NULL) {
+		memcpy(e, darr_first(d), d->element_size);
+	}
+
+	size_t n = darr_size(d) - 1;
+
+	// The last element is sifted down from the top without being copied
+	// out first. Sifting only writes to the first n elements so it stays
+	// intact until the array shrinks.
+	if (n > 0) {
+		darr_heap_sift_down(d, arity, compare, 0, n, darr_element(d, n));
+	}
+
+	// The top has been overwritten, so the pop must go through.
+	darr_truncate(d, n);
+
+	return 1;
+}
+
+int darr_heap_replace(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	const void *e,
+	void *out)
+{
+	if (darr_empty(d)) {
+		return 0;
+	}
+
+	if (out != NULL) {
+		memcpy(out, darr_first(d), d->element_size);
+	}
+
+	darr_heap_sift_down(d, arity, compare, 0, darr_size(d), e);
+	return 1;
+}
+
+int darr_heap_update(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	size_t i)
+{
+	struct darr_heap_temp temp;
+
+	if (!darr_heap_temp_init(&temp, d->element_size)) {
+		return 0;
+	}
+
+	memcpy(temp.data, darr_element(d, i), d->element_size);
+
+	if (i > 0 && compare(temp.data, darr_element(d, (i - 1) / arity)) < 0) {
+		darr_heap_sift_up(d, arity, compare, i, temp.data);
+	} else {
+		darr_heap_sift_down(d, arity, compare, i, darr_size(d), temp.data);
+	}
+
+	darr_heap_temp_deinit(&temp);
+	return 1;
+}
@@ -0,0 +1,106 @@
+#ifndef DARR_DARR_HEAP_H
+#define DARR_DARR_HEAP_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compares two elements. Must return a negative number if the first element
+ * comes before the second one, a positive number if it comes after and zero
+ * if they are equal. This is the same contract as the comparison function of
+ * qsort.
+ */
+typedef int (*darr_heap_compare_t)(const void *, const void *);
+
+/*
+ * The heap functions keep the elements of an array ordered as a d-ary heap:
+ * the element at index i comes before or is equal to its children, which are
+ * at indexes i * arity + 1 up to i * arity + arity. The first element of the
+ * array is therefore always one that comes before all the others.
+ *
+ * The arity must be at least 2 and must be the same in every call made on the
+ * same array. A binary heap has an arity of 2. With an arity of 4 or 8 the
+ * heap is shallower and the children of an element are next to each other in
+ * memory, often in the same cache line, which makes popping cheaper for
+ * small elements.
+ *
+ * Elements are sifted by moving them into a hole instead of swapping pairs,
+ * so each level costs one copy instead of three.
+ */
+
+/*
+ * Reorders the elements of the array so that they form a heap.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array remains untouched.
+ */
+int darr_heapify(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare);
+
+/*
+ * Adds a copy of an element to the heap. The element must not be stored in
+ * the array.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array remains untouched.
+ */
+int darr_heap_push(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	const void *e);
+
+/*
+ * Removes the first element of the heap. If e is not NULL, the element is
+ * copied to it before being removed.
+ *
+ * Returns 1 on success, 0 if the array is empty.
+ */
+int darr_heap_pop(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	void *e);
+
+/*
+ * Removes the first element of the heap and adds a copy of another element in
+ * a single sift. If out is not NULL, the removed element is copied to it. The
+ * added element must not be stored in the array.
+ *
+ * Unlike a pop followed by a push, this does not change the size of the
+ * array and so never reallocates it.
+ *
+ * Returns 1 on success, 0 on failure. Fails if the array is empty.
+ */
+int darr_heap_replace(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	const void *e,
+	void *out);
+
+/*
+ * Restores the heap after the element at index i was changed in place.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array remains untouched.
+ */
+int darr_heap_update(
+	struct darr *d,
+	size_t arity,
+	darr_heap_compare_t compare,
+	size_t i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_HEAP_H */
@@ -0,0 +1,358 @@
+#include "darr_hindex.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * Control byte values. Slots in use hold the lowest 7 bits of the hash of
+ * their key, which never have the highest bit set.
+ */
+#define DARR_HINDEX_EMPTY 0x80
+#define DARR_HINDEX_DELETED 0xfe
+
+/*
+ * Number of slots probed at once.
+ */
+#define DARR_HINDEX_GROUP 16
+
+extern inline void darr_hindex_init(
+	struct darr_hindex *h,
+	size_t key_offset,
+	size_t key_size);
+
+extern inline void darr_hindex_deinit(struct darr_hindex *h);
+
+extern inline size_t darr_hindex_size(const struct darr_hindex *h);
+
+static const unsigned char *darr_hindex_key(
+	const struct darr_hindex *h,
+	const struct darr *d,
+	size_t i)
+{
+	return (const unsigned char *) darr_element_const(d, i) + h->key_offset;
+}
+
+/*
+ * FNV-1a followed by the finalizer of MurmurHash3 so that every bit of the
+ * key affects the bits used for the control byte and the group.
+ */
+static uint64_t darr_hindex_hash(const struct darr_hindex *h, const void *key)
+{
+	const unsigned char *p = (const unsigned char *) key;
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+	for (size_t i = 0; i < h->key_size; ++i) {
+		hash ^= p[i];
+		hash *= UINT64_C(0x100000001b3);
+	}
+
+	hash ^= hash >> 33;
+	hash *= UINT64_C(0xff51afd7ed558ccd);
+	hash ^= hash >> 33;
+	hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+	hash ^= hash >> 33;
+	return hash;
+}
+
+/*
+ * Returns a bit mask with bit j set if the control byte j of the group is
+ * equal to the given value.
+ */
+static unsigned darr_hindex_match(const uint8_t *group, uint8_t value)
+{
+#ifdef __SSE2__
+	__m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+	__m128i match = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) value));
+	return (unsigned) _mm_movemask_epi8(match);
+#else
+	unsigned mask = 0;
+
+	for (unsigned j = 0; j < DARR_HINDEX_GROUP; ++j) {
+		if (group[j] == value) {
+			mask |= 1u << j;
+		}
+	}
+
+	return mask;
+#endif
+}
+
+/*
+ * Returns a bit mask with bit j set if the control byte j of the group is
+ * either empty or deleted.
+ */
+static unsigned darr_hindex_match_free(const uint8_t *group)
+{
+#ifdef __SSE2__
+	// Only empty and deleted control bytes have the highest bit set.
+	__m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+	return (unsigned) _mm_movemask_epi8(ctrl);
+#else
+	unsigned mask = 0;
+
+	for (unsigned j = 0; j < DARR_HINDEX_GROUP; ++j) {
+		if (group[j] & 0x80) {
+			mask |= 1u << j;
+		}
+	}
+
+	return mask;
+#endif
+}
+
+static size_t darr_hindex_capacity(const struct darr_hindex *h)
+{
+	return darr_size(&h->ctrl);
+}
+
+static uint8_t *darr_hindex_ctrl(const struct darr_hindex *h)
+{
+	return (uint8_t *) darr_data((struct darr *) &h->ctrl);
+}
+
+static size_t *darr_hindex_slots(const struct darr_hindex *h)
+{
+	return (size_t *) darr_data((struct darr *) &h->slots);
+}
+
+/*
+ * Finds the slot that refers to the element with the given key. If i is not
+ * the size of the array, the slot must also refer to element i.
+ *
+ * Returns the capacity of the table if there is no such slot.
+ */
+static size_t darr_hindex_lookup(
+	const struct darr_hindex *h,
+	const struct darr *d,
+	const void *key,
+	size_t i)
+{
+	size_t capacity = darr_hindex_capacity(h);
+
+	if (capacity == 0) {
+		return capacity;
+	}
+
+	const uint8_t *ctrl = darr_hindex_ctrl(h);
+	const size_t *slots = darr_hindex_slots(h);
+	uint64_t hash = darr_hindex_hash(h, key);
+	uint8_t tag = hash & 0x7f;
+	size_t groups_mask = capacity / DARR_HINDEX_GROUP - 1;
+	size_t g = (hash >> 7) & groups_mask;
+
+	for (size_t step = 1;; ++step) {
+		const uint8_t *group = ctrl + g * DARR_HINDEX_GROUP;
+		unsigned mask = darr_hindex_match(group, tag);
+
+		while (mask) {
+			size_t slot = g * DARR_HINDEX_GROUP + __builtin_ctz(mask);
+			size_t index = slots[slot];
+
+			if ((i == darr_size(d) || index == i)
+				&& memcmp(
+					darr_hindex_key(h, d, index),
+					key,
+					h->key_size) == 0) {
+				return slot;
+			}
+
+			mask &= mask - 1;
+		}
+
+		// The table always has empty slots so probing ends.
+		if (darr_hindex_match(group, DARR_HINDEX_EMPTY)) {
+			return capacity;
+		}
+
+		g = (g + step) & groups_mask;
+	}
+}
+
+/*
+ * Stores element i in a free slot. The table must have room for it.
+ */
+static void darr_hindex_place(
+	struct darr_hindex *h,
+	const struct darr *d,
+	size_t i)
+{
+	uint8_t *ctrl = darr_hindex_ctrl(h);
+	size_t *slots = darr_hindex_slots(h);
+	uint64_t hash = darr_hindex_hash(h, darr_hindex_key(h, d, i));
+	size_t groups_mask = darr_hindex_capacity(h) / DARR_HINDEX_GROUP - 1;
+	size_t g = (hash >> 7) & groups_mask;
+
+	for (size_t step = 1;; ++step) {
+		unsigned mask = darr_hindex_match_free(ctrl + g * DARR_HINDEX_GROUP);
+
+		if (mask) {
+			size_t slot = g * DARR_HINDEX_GROUP + __builtin_ctz(mask);
+
+			if (ctrl[slot] == DARR_HINDEX_DELETED) {
+				h->deleted -= 1;
+			}
+
+			ctrl[slot] = hash & 0x7f;
+			slots[slot] = i;
+			h->count += 1;
+			return;
+		}
+
+		g = (g + step) & groups_mask;
+	}
+}
+
+/*
+ * Allocates a table with room for at least the given number of elements and
+ * stores every element of the old table in it.
+ */
+static int darr_hindex_rehash(
+	struct darr_hindex *h,
+	const struct darr *d,
+	size_t count)
+{
+	// At most 7/8 of the slots are used so that probing stays short.
+	size_t capacity = DARR_HINDEX_GROUP;
+
+	while (capacity / 8 * 7 <= count) {
+		capacity *= 2;
+	}
+
+	struct darr ctrl;
+	struct darr slots;
+	darr_init(&ctrl, sizeof(uint8_t));
+	darr_init(&slots, sizeof(size_t));
+
+	if (!darr_resize(&ctrl, capacity) || !darr_resize(&slots, capacity)) {
+		darr_deinit(&ctrl);
+		darr_deinit(&slots);
+		return 0;
+	}
+
+	memset(darr_data(&ctrl), DARR_HINDEX_EMPTY, capacity);
+
+	darr_swap(&ctrl, &h->ctrl);
+	darr_swap(&slots, &h->slots);
+
+	const uint8_t *old_ctrl = (const uint8_t *) darr_data(&ctrl);
+	const size_t *old_slots = (const size_t *) darr_data(&slots);
+
+	h->count = 0;
+	h->deleted = 0;
+
+	for (size_t slot = 0; slot < darr_size(&ctrl); ++slot) {
+		if (!(old_ctrl[slot] & 0x80)) {
+			darr_hindex_place(h, d, old_slots[slot]);
+		}
+	}
+
+	darr_deinit(&ctrl);
+	darr_deinit(&slots);
+	return 1;
+}
+
+void darr_hindex_clear(struct darr_hindex *h)
+{
+	if (!darr_empty(&h->ctrl)) {
+		memset(darr_data(&h->ctrl), DARR_HINDEX_EMPTY, darr_size(&h->ctrl));
+	}
+
+	h->count = 0;
+	h->deleted = 0;
+}
+
+int darr_hindex_build(struct darr_hindex *h, const struct darr *d)
+{
+	darr_hindex_clear(h);
+
+	if (!darr_hindex_rehash(h, d, darr_size(d))) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < darr_size(d); ++i) {
+		darr_hindex_place(h, d, i);
+	}
+
+	return 1;
+}
+
+size_t darr_hindex_find(
+	const struct darr_hindex *h,
+	const struct darr *d,
+	const void *key)
+{
+	size_t slot = darr_hindex_lookup(h, d, key, darr_size(d));
+
+	if (slot == darr_hindex_capacity(h)) {
+		return darr_size(d);
+	}
+
+	return darr_hindex_slots(h)[slot];
+}
+
+int darr_hindex_insert(struct darr_hindex *h, const struct darr *d, size_t i)
+{
+	size_t used = h->count + h->deleted + 1;
+
+	if (used > darr_hindex_capacity(h) / 8 * 7) {
+		if (!darr_hindex_rehash(h, d, h->count + 1)) {
+			return 0;
+		}
+	}
+
+	darr_hindex_place(h, d, i);
+	return 1;
+}
+
+void darr_hindex_erase(struct darr_hindex *h, const struct darr *d, size_t i)
+{
+	size_t slot = darr_hindex_lookup(h, d, darr_hindex_key(h, d, i), i);
+
+	if (slot == darr_hindex_capacity(h)) {
+		return;
+	}
+
+	darr_hindex_ctrl(h)[slot] = DARR_HINDEX_DELETED;
+	h->count -= 1;
+	h->deleted += 1;
+}
+
+int darr_hindex_push(struct darr_hindex *h, struct darr *d, const void *e)
+{
+	if (!darr_grow(d, 1)) {
+		return 0;
+	}
+
+	memcpy(darr_last(d), e, d->element_size);
+
+	if (!darr_hindex_insert(h, d, darr_size(d) - 1)) {
+		darr_shrink(d, 1);
+		return 0;
+	}
+
+	return 1;
+}
+
+int darr_hindex_swap_remove(struct darr_hindex *h, struct darr *d, size_t i)
+{
+	size_t last = darr_size(d) - 1;
+
+	darr_hindex_erase(h, d, i);
+
+	if (i != last) {
+		size_t slot = darr_hindex_lookup(
+			h,
+			d,
+			darr_hindex_key(h, d, last),
+			last);
+
+		if (slot != darr_hindex_capacity(h)) {
+			darr_hindex_slots(h)[slot] = i;
+		}
+
+		memcpy(darr_element(d, i), darr_element(d, last), d->element_size);
+	}
+
+	return darr_shrink(d, 1);
+}
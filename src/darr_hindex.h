@@ -0,0 +1,141 @@
+#ifndef DARR_DARR_HINDEX_H
+#define DARR_DARR_HINDEX_H
+
+#include <stdint.h>
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A hash index over the elements of an array. Maps the bytes of a key stored
+ * inside every element to the index of the element, so that elements can be
+ * found by key without scanning the array.
+ *
+ * The key of an element is the key_size bytes found key_offset bytes from
+ * the start of the element. Keys are compared byte by byte.
+ *
+ * The index does not own the array. Every function that needs to read keys
+ * takes the array as a parameter and it must always be the same array. When
+ * the array changes, the index must be told with darr_hindex_insert and
+ * darr_hindex_erase, or the changes can be made through darr_hindex_push and
+ * darr_hindex_swap_remove, which update both. Changes that move many
+ * elements around, such as darr_insert or darr_remove, require rebuilding
+ * the index with darr_hindex_build.
+ *
+ * The table uses open addressing with one control byte per slot that holds
+ * 7 bits of the hash. Control bytes are probed 16 at a time with SSE2 when
+ * the compiler targets it.
+ *
+ * You can initialize it by calling darr_hindex_init.
+ */
+struct darr_hindex {
+	size_t key_offset;
+	size_t key_size;
+	size_t count;
+	size_t deleted;
+	struct darr ctrl;
+	struct darr slots;
+};
+
+/*
+ * Initializes a darr_hindex struct for keys of key_size bytes stored at
+ * key_offset bytes from the start of each element.
+ *
+ * The index starts out empty. Call darr_hindex_build to index the elements of
+ * an array.
+ *
+ * Call darr_hindex_deinit to deinitialize.
+ */
+inline void darr_hindex_init(
+	struct darr_hindex *h,
+	size_t key_offset,
+	size_t key_size)
+{
+	h->key_offset = key_offset;
+	h->key_size = key_size;
+	h->count = 0;
+	h->deleted = 0;
+	darr_init(&h->ctrl, sizeof(uint8_t));
+	darr_init(&h->slots, sizeof(size_t));
+}
+
+/*
+ * Deinitializes a darr_hindex struct.
+ */
+inline void darr_hindex_deinit(struct darr_hindex *h)
+{
+	darr_deinit(&h->ctrl);
+	darr_deinit(&h->slots);
+}
+
+/*
+ * Returns the number of elements in the index.
+ */
+inline size_t darr_hindex_size(const struct darr_hindex *h)
+{
+	return h->count;
+}
+
+/*
+ * Removes every element from the index.
+ */
+void darr_hindex_clear(struct darr_hindex *h);
+
+/*
+ * Replaces the contents of the index with every element of the array.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the index is left empty.
+ */
+int darr_hindex_build(struct darr_hindex *h, const struct darr *d);
+
+/*
+ * Returns the index of an element whose key is equal to the given one.
+ *
+ * If there is none, returns the size of the array. If several elements have
+ * the same key, any one of them may be returned.
+ */
+size_t darr_hindex_find(
+	const struct darr_hindex *h,
+	const struct darr *d,
+	const void *key);
+
+/*
+ * Adds the element at index i of the array to the index.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int darr_hindex_insert(struct darr_hindex *h, const struct darr *d, size_t i);
+
+/*
+ * Removes the element at index i of the array from the index. Must be called
+ * while the element is still in the array.
+ */
+void darr_hindex_erase(struct darr_hindex *h, const struct darr *d, size_t i);
+
+/*
+ * Adds a copy of an element to the end of the array and to the index.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array and the index remain untouched.
+ */
+int darr_hindex_push(struct darr_hindex *h, struct darr *d, const void *e);
+
+/*
+ * Removes the element at index i from the array and the index by moving the
+ * last element into its place.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int darr_hindex_swap_remove(struct darr_hindex *h, struct darr *d, size_t i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_HINDEX_H */
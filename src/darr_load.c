@@ -0,0 +1,647 @@
+#define _GNU_SOURCE
+
+#include "darr_load.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define DARR_LOAD_IO_URING
+#endif
+#endif
+
+#ifdef DARR_LOAD_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+/*
+ * Number of bytes read at a time.
+ */
+#define DARR_LOAD_CHUNK (4 << 20)
+
+/*
+ * Offsets and sizes of O_DIRECT reads must be multiples of this.
+ */
+#define DARR_LOAD_BLOCK 4096
+
+/*
+ * Number of chunks read at the same time through io_uring.
+ */
+#define DARR_LOAD_DEPTH 2
+
+/*
+ * delivered is the number of chunks handed to the callback so far, which are
+ * not read again when a load is retried. rejected is set when a read fails
+ * because the file does not allow O_DIRECT reads after all.
+ */
+struct darr_load {
+	struct darr *d;
+	int fd;
+	int direct;
+	int rejected;
+	size_t bytes;
+	size_t chunk;
+	size_t chunks;
+	size_t delivered;
+	darr_load_chunk_t fn;
+	void *ctx;
+};
+
+static size_t darr_load_gcd(size_t a, size_t b)
+{
+	while (b != 0) {
+		size_t r = a % b;
+		a = b;
+		b = r;
+	}
+
+	return a;
+}
+
+/*
+ * Returns the number of bytes of chunk k.
+ */
+static size_t darr_load_chunk_size(const struct darr_load *l, size_t k)
+{
+	size_t offset = k * l->chunk;
+	return l->bytes - offset < l->chunk ? l->bytes - offset : l->chunk;
+}
+
+/*
+ * Returns the number of bytes to ask for when reading the given number of
+ * bytes. O_DIRECT reads must cover whole blocks, so the last one reads past
+ * the end of the data into the padding of the array.
+ */
+static size_t darr_load_request_size(const struct darr_load *l, size_t len)
+{
+	if (!l->direct) {
+		return len;
+	}
+
+	return (len + DARR_LOAD_BLOCK - 1) / DARR_LOAD_BLOCK * DARR_LOAD_BLOCK;
+}
+
+static int darr_load_deliver(struct darr_load *l, size_t k)
+{
+	size_t es = l->d->element_size;
+	size_t offset = k * l->chunk;
+
+	if (l->fn != NULL
+		&& !l->fn(
+			l->ctx,
+			darr_element(l->d, offset / es),
+			offset / es,
+			darr_load_chunk_size(l, k) / es)) {
+		return 0;
+	}
+
+	l->delivered = k + 1;
+	return 1;
+}
+
+/*
+ * Reads every chunk that was not delivered yet with blocking reads.
+ */
+static int darr_load_pread(struct darr_load *l)
+{
+	char *data = darr_data(l->d);
+
+	for (size_t k = l->delivered; k < l->chunks; ++k) {
+		size_t offset = k * l->chunk;
+		size_t len = darr_load_chunk_size(l, k);
+		size_t done = 0;
+
+		while (done < len) {
+			ssize_t n = pread(
+				l->fd,
+				data + offset + done,
+				darr_load_request_size(l, len - done),
+				(off_t) (offset + done));
+
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+
+			if (n < 0 && errno == EINVAL && l->direct) {
+				l->rejected = 1;
+				return 0;
+			}
+
+			// The file got shorter while it was being read.
+			if (n <= 0) {
+				return 0;
+			}
+
+			done += (size_t) n;
+		}
+
+		if (!darr_load_deliver(l, k)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+#ifdef DARR_LOAD_IO_URING
+/*
+ * The parts of an io_uring instance that are shared with the kernel.
+ */
+struct darr_load_ring {
+	int fd;
+	void *sq_ptr;
+	size_t sq_len;
+	void *cq_ptr;
+	size_t cq_len;
+	struct io_uring_sqe *sqes;
+	size_t sqes_len;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_cqe *cqes;
+};
+
+static void darr_load_ring_deinit(struct darr_load_ring *r)
+{
+	if (r->sqes != NULL) {
+		munmap(r->sqes, r->sqes_len);
+	}
+
+	if (r->cq_ptr != NULL && r->cq_ptr != r->sq_ptr) {
+		munmap(r->cq_ptr, r->cq_len);
+	}
+
+	if (r->sq_ptr != NULL) {
+		munmap(r->sq_ptr, r->sq_len);
+	}
+
+	close(r->fd);
+}
+
+/*
+ * Sets up an io_uring instance. Returns 0 if the kernel does not provide
+ * io_uring or does not allow its use.
+ */
+static int darr_load_ring_init(struct darr_load_ring *r, unsigned entries)
+{
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	memset(r, 0, sizeof(*r));
+
+	r->fd = (int) syscall(__NR_io_uring_setup, entries, &p);
+
+	if (r->fd < 0) {
+		return 0;
+	}
+
+	r->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	r->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (r->cq_len > r->sq_len) {
+			r->sq_len = r->cq_len;
+		}
+
+		r->cq_len = r->sq_len;
+	}
+
+	void *sq = mmap(
+		NULL,
+		r->sq_len,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		r->fd,
+		IORING_OFF_SQ_RING);
+
+	if (sq == MAP_FAILED) {
+		darr_load_ring_deinit(r);
+		return 0;
+	}
+
+	r->sq_ptr = sq;
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		r->cq_ptr = sq;
+	} else {
+		void *cq = mmap(
+			NULL,
+			r->cq_len,
+			PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE,
+			r->fd,
+			IORING_OFF_CQ_RING);
+
+		if (cq == MAP_FAILED) {
+			darr_load_ring_deinit(r);
+			return 0;
+		}
+
+		r->cq_ptr = cq;
+	}
+
+	r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+
+	void *sqes = mmap(
+		NULL,
+		r->sqes_len,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		r->fd,
+		IORING_OFF_SQES);
+
+	if (sqes == MAP_FAILED) {
+		darr_load_ring_deinit(r);
+		return 0;
+	}
+
+	r->sqes = sqes;
+
+	char *sqp = r->sq_ptr;
+	char *cqp = r->cq_ptr;
+	r->sq_tail = (unsigned *) (sqp + p.sq_off.tail);
+	r->sq_mask = (unsigned *) (sqp + p.sq_off.ring_mask);
+	r->sq_array = (unsigned *) (sqp + p.sq_off.array);
+	r->cq_head = (unsigned *) (cqp + p.cq_off.head);
+	r->cq_tail = (unsigned *) (cqp + p.cq_off.tail);
+	r->cq_mask = (unsigned *) (cqp + p.cq_off.ring_mask);
+	r->cqes = (struct io_uring_cqe *) (cqp + p.cq_off.cqes);
+	return 1;
+}
+
+/*
+ * Queues a read described by an iovec and hands it to the kernel.
+ */
+static int darr_load_ring_read(
+	struct darr_load_ring *r,
+	int fd,
+	const struct iovec *iov,
+	size_t offset,
+	uint64_t user_data)
+{
+	unsigned tail = *r->sq_tail;
+	unsigned index = tail & *r->sq_mask;
+	struct io_uring_sqe *sqe = &r->sqes[index];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t) (uintptr_t) iov;
+	sqe->len = 1;
+	sqe->off = offset;
+	sqe->user_data = user_data;
+
+	r->sq_array[index] = index;
+	__atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	for (;;) {
+		long n = syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0);
+
+		if (n >= 0) {
+			return n == 1;
+		}
+
+		if (errno != EINTR) {
+			return 0;
+		}
+	}
+}
+
+/*
+ * Waits for a read to complete.
+ */
+static int darr_load_ring_wait(
+	struct darr_load_ring *r,
+	struct io_uring_cqe *cqe)
+{
+	for (;;) {
+		unsigned head = *r->cq_head;
+
+		if (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+			*cqe = r->cqes[head & *r->cq_mask];
+			__atomic_store_n(
+				r->cq_head,
+				head + 1,
+				__ATOMIC_RELEASE);
+			return 1;
+		}
+
+		long n = syscall(
+			__NR_io_uring_enter,
+			r->fd,
+			0,
+			1,
+			IORING_ENTER_GETEVENTS,
+			NULL,
+			0);
+
+		if (n < 0 && errno != EINTR) {
+			return 0;
+		}
+	}
+}
+
+/*
+ * A chunk that is being read. Chunk k is always read by slot k % depth.
+ */
+struct darr_load_slot {
+	struct iovec iov;
+	size_t offset;
+	size_t len;
+	size_t done;
+	int busy;
+};
+
+/*
+ * Starts reading the rest of the chunk of a slot.
+ */
+static int darr_load_slot_read(
+	const struct darr_load *l,
+	struct darr_load_ring *r,
+	struct darr_load_slot *s,
+	size_t i)
+{
+	char *data = darr_data(l->d);
+
+	s->iov.iov_base = data + s->offset + s->done;
+	s->iov.iov_len = darr_load_request_size(l, s->len - s->done);
+
+	if (!darr_load_ring_read(r, l->fd, &s->iov, s->offset + s->done, i)) {
+		return 0;
+	}
+
+	s->busy = 1;
+	return 1;
+}
+
+static int darr_load_slot_start(
+	const struct darr_load *l,
+	struct darr_load_ring *r,
+	struct darr_load_slot *s,
+	size_t i,
+	size_t k)
+{
+	s->offset = k * l->chunk;
+	s->len = darr_load_chunk_size(l, k);
+	s->done = 0;
+	return darr_load_slot_read(l, r, s, i);
+}
+
+/*
+ * Reads every chunk that was not delivered yet through io_uring, keeping
+ * several reads in flight while chunks that were read are handed to the
+ * callback in order.
+ *
+ * Returns -1 if io_uring cannot be used.
+ */
+static int darr_load_uring(struct darr_load *l)
+{
+	struct darr_load_ring r;
+
+	if (!darr_load_ring_init(&r, DARR_LOAD_DEPTH)) {
+		return -1;
+	}
+
+	struct darr_load_slot slots[DARR_LOAD_DEPTH];
+	memset(slots, 0, sizeof(slots));
+
+	size_t submitted = l->delivered;
+	size_t delivered = l->delivered;
+	int ok = 1;
+
+	while (submitted < l->chunks
+		&& submitted < delivered + DARR_LOAD_DEPTH) {
+		size_t i = submitted % DARR_LOAD_DEPTH;
+
+		if (!darr_load_slot_start(l, &r, &slots[i], i, submitted)) {
+			ok = 0;
+			break;
+		}
+
+		submitted += 1;
+	}
+
+	while (ok && delivered < l->chunks) {
+		struct io_uring_cqe cqe;
+
+		if (!darr_load_ring_wait(&r, &cqe)) {
+			ok = 0;
+			break;
+		}
+
+		size_t i = (size_t) cqe.user_data;
+		struct darr_load_slot *s = &slots[i];
+		s->busy = 0;
+
+		if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+			ok = darr_load_slot_read(l, &r, s, i);
+			continue;
+		}
+
+		if (cqe.res == -EINVAL && l->direct) {
+			l->rejected = 1;
+			ok = 0;
+			break;
+		}
+
+		// Errors and reads that hit the end of the file early.
+		if (cqe.res <= 0) {
+			ok = 0;
+			break;
+		}
+
+		s->done += (size_t) cqe.res;
+
+		if (s->done < s->len) {
+			ok = darr_load_slot_read(l, &r, s, i);
+			continue;
+		}
+
+		// Hands over every chunk that is complete and next in order,
+		// reusing its slot for the next chunk to read.
+		for (;;) {
+			size_t j = delivered % DARR_LOAD_DEPTH;
+			struct darr_load_slot *next = &slots[j];
+
+			if (delivered == submitted || next->busy
+				|| next->done < next->len) {
+				break;
+			}
+
+			if (!darr_load_deliver(l, delivered)) {
+				ok = 0;
+				break;
+			}
+
+			delivered += 1;
+
+			if (submitted < l->chunks) {
+				ok = darr_load_slot_start(
+					l,
+					&r,
+					next,
+					j,
+					submitted);
+
+				if (!ok) {
+					break;
+				}
+
+				submitted += 1;
+			}
+		}
+	}
+
+	// The kernel may still be writing into the array, which the caller is
+	// about to free.
+	for (size_t i = 0; i < DARR_LOAD_DEPTH; ++i) {
+		while (slots[i].busy) {
+			struct io_uring_cqe cqe;
+
+			if (!darr_load_ring_wait(&r, &cqe)) {
+				break;
+			}
+
+			slots[cqe.user_data].busy = 0;
+		}
+	}
+
+	darr_load_ring_deinit(&r);
+	return ok;
+}
+#endif
+
+/*
+ * Reopens the file with O_DIRECT if the array allows it.
+ */
+static void darr_load_direct(struct darr_load *l, const char *path)
+{
+	struct darr *d = l->d;
+	size_t blocks = (l->bytes + DARR_LOAD_BLOCK - 1) / DARR_LOAD_BLOCK;
+	size_t needed = blocks * DARR_LOAD_BLOCK;
+
+	if (d->alignment == 0 || d->alignment % DARR_LOAD_BLOCK != 0
+		|| needed > l->bytes + d->padding) {
+		return;
+	}
+
+	int fd = open(path, O_RDONLY | O_DIRECT);
+
+	if (fd < 0) {
+		return;
+	}
+
+	close(l->fd);
+	l->fd = fd;
+	l->direct = 1;
+}
+
+/*
+ * Reopens the file without O_DIRECT after a direct read was rejected. Chunks
+ * of a direct load hold whole elements, so they are kept as they are.
+ */
+static int darr_load_buffered(struct darr_load *l, const char *path)
+{
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0) {
+		return 0;
+	}
+
+	close(l->fd);
+	l->fd = fd;
+	l->direct = 0;
+	l->rejected = 0;
+	return 1;
+}
+
+/*
+ * Reads the chunks that were not delivered yet, through io_uring unless the
+ * flags ask for blocking reads or it cannot be used.
+ */
+static int darr_load_read(struct darr_load *l, int flags)
+{
+	int ok = -1;
+
+#ifdef DARR_LOAD_IO_URING
+	if (!(flags & DARR_LOAD_SYNC)) {
+		ok = darr_load_uring(l);
+	}
+#else
+	(void) flags;
+#endif
+
+	if (ok < 0) {
+		ok = darr_load_pread(l);
+	}
+
+	return ok;
+}
+
+int darr_load_file(
+	struct darr *d,
+	const char *path,
+	int flags,
+	darr_load_chunk_t fn,
+	void *ctx)
+{
+	struct darr_load l;
+	l.d = d;
+	l.direct = 0;
+	l.rejected = 0;
+	l.delivered = 0;
+	l.fn = fn;
+	l.ctx = ctx;
+	l.fd = open(path, O_RDONLY);
+
+	if (l.fd < 0) {
+		return 0;
+	}
+
+	struct stat st;
+
+	if (fstat(l.fd, &st) != 0
+		|| (size_t) st.st_size % d->element_size != 0
+		|| !darr_resize(d, (size_t) st.st_size / d->element_size)) {
+		close(l.fd);
+		return 0;
+	}
+
+	l.bytes = (size_t) st.st_size;
+
+	if (flags & DARR_LOAD_DIRECT) {
+		darr_load_direct(&l, path);
+	}
+
+	// Chunks hold whole elements and, for O_DIRECT, whole blocks.
+	size_t es = d->element_size;
+	size_t step = l.direct
+		? es / darr_load_gcd(es, DARR_LOAD_BLOCK) * DARR_LOAD_BLOCK
+		: es;
+	l.chunk = DARR_LOAD_CHUNK > step ? DARR_LOAD_CHUNK / step * step : step;
+	l.chunks = (l.bytes + l.chunk - 1) / l.chunk;
+
+	int ok = darr_load_read(&l, flags);
+
+	// Some file systems accept O_DIRECT when the file is opened but fail
+	// the reads. The rest of the file is then read through the page cache.
+	if (!ok && l.rejected && darr_load_buffered(&l, path)) {
+		ok = darr_load_read(&l, flags);
+	}
+
+	close(l.fd);
+
+	if (!ok) {
+		darr_resize(d, 0);
+	}
+
+	return ok;
+}
@@ -0,0 +1,63 @@
+#ifndef DARR_DARR_LOAD_H
+#define DARR_DARR_LOAD_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Flags for darr_load_file.
+ *
+ * DARR_LOAD_DIRECT bypasses the page cache with O_DIRECT. It only takes
+ * effect if the data of the array is aligned to 4096 bytes and has room for
+ * the size of the file rounded up to 4096 bytes, which is the case for
+ * arrays initialized with darr_init_aligned(d, element_size, 4096, 4096). It
+ * is ignored otherwise, and also if the file system does not support it.
+ *
+ * DARR_LOAD_SYNC always uses blocking reads.
+ */
+#define DARR_LOAD_DIRECT 1
+#define DARR_LOAD_SYNC 2
+
+/*
+ * Called by darr_load_file for every chunk of elements once it has been
+ * read, in the order of the file. Must return 1 to continue loading or 0 to
+ * stop.
+ */
+typedef int (*darr_load_chunk_t)(
+	void *ctx,
+	void *elements,
+	size_t start,
+	size_t count);
+
+/*
+ * Replaces the elements of the array with the contents of a file. The size
+ * of the file must be a multiple of the element size.
+ *
+ * The array is resized once and the file is read straight into it in chunks
+ * of a few megabytes. On Linux two chunks are read at a time through
+ * io_uring so that fn can process a chunk while the next one is being read.
+ * Where io_uring is not available, chunks are read one after the other with
+ * pread.
+ *
+ * fn may be NULL.
+ *
+ * Returns 1 on success, 0 on failure. Fails if fn returns 0.
+ *
+ * On failure the array is left empty, unless the file could not be opened or
+ * the array could not be resized, in which case it remains untouched.
+ */
+int darr_load_file(
+	struct darr *d,
+	const char *path,
+	int flags,
+	darr_load_chunk_t fn,
+	void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_LOAD_H */
@@ -0,0 +1,395 @@
+#include "darr_packed.h"
+#include "darr_cpu.h"
+
+#ifdef DARR_CPU_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * Values of a block are spread over this many lanes. Value i of the block
+ * goes to lane i % 4 and each lane is packed into its own sequence of words.
+ * Word w of lane l is stored at word w * 4 + l of the block.
+ */
+#define DARR_PACKED_LANES 4
+
+extern inline void darr_packed_init(struct darr_packed *p);
+
+extern inline void darr_packed_deinit(struct darr_packed *p);
+
+extern inline size_t darr_packed_size(const struct darr_packed *p);
+
+extern inline size_t darr_packed_bytes(const struct darr_packed *p);
+
+/*
+ * Returns the number of words a block takes when each difference uses the
+ * given number of bits.
+ */
+static size_t darr_packed_block_words(unsigned bits)
+{
+	size_t lane_bits = DARR_PACKED_BLOCK / DARR_PACKED_LANES * bits;
+	return (lane_bits + 63) / 64 * DARR_PACKED_LANES;
+}
+
+/*
+ * Packs 128 differences of the given number of bits into words. The words
+ * must be zeroed.
+ */
+static void darr_packed_encode_scalar(
+	const uint64_t *deltas,
+	unsigned bits,
+	uint64_t *words)
+{
+	size_t values = DARR_PACKED_BLOCK / DARR_PACKED_LANES;
+
+	for (size_t l = 0; l < DARR_PACKED_LANES; ++l) {
+		uint64_t acc = 0;
+		unsigned shift = 0;
+		size_t w = 0;
+
+		for (size_t k = 0; k < values; ++k) {
+			uint64_t v = deltas[k * DARR_PACKED_LANES + l];
+
+			acc |= v << shift;
+			shift += bits;
+
+			if (shift >= 64) {
+				words[w * DARR_PACKED_LANES + l] = acc;
+				w += 1;
+				shift -= 64;
+
+				// Bits that did not fit start the next word.
+				acc = shift == 0 ? 0 : v >> (bits - shift);
+			}
+		}
+
+		if (shift > 0) {
+			words[w * DARR_PACKED_LANES + l] = acc;
+		}
+	}
+}
+
+/*
+ * Unpacks the 128 differences of a block of the given number of bits, which
+ * is not zero, and adds them up starting from base.
+ */
+static void darr_packed_decode_scalar(
+	const uint64_t *words,
+	unsigned bits,
+	uint64_t base,
+	uint64_t *values)
+{
+	size_t count = DARR_PACKED_BLOCK / DARR_PACKED_LANES;
+	uint64_t mask = bits == 64 ? ~UINT64_C(0) : (UINT64_C(1) << bits) - 1;
+
+	for (size_t l = 0; l < DARR_PACKED_LANES; ++l) {
+		unsigned shift = 0;
+		size_t w = 0;
+
+		for (size_t k = 0; k < count; ++k) {
+			uint64_t v = words[w * DARR_PACKED_LANES + l] >> shift;
+
+			if (shift + bits > 64) {
+				v |= words[(w + 1) * DARR_PACKED_LANES + l]
+					<< (64 - shift);
+			}
+
+			values[k * DARR_PACKED_LANES + l] = v & mask;
+			shift += bits;
+
+			if (shift >= 64) {
+				w += 1;
+				shift -= 64;
+			}
+		}
+	}
+
+	uint64_t sum = base;
+
+	for (size_t i = 0; i < DARR_PACKED_BLOCK; ++i) {
+		sum += values[i];
+		values[i] = sum;
+	}
+}
+
+/*
+ * The AVX2 kernels handle the 4 lanes at once, one 256 bit vector per word
+ * of every lane.
+ */
+#ifdef DARR_CPU_X86
+DARR_CPU_TARGET("avx2")
+static void darr_packed_encode_avx2(
+	const uint64_t *deltas,
+	unsigned bits,
+	uint64_t *words)
+{
+	size_t values = DARR_PACKED_BLOCK / DARR_PACKED_LANES;
+	__m256i acc = _mm256_setzero_si256();
+	unsigned shift = 0;
+	size_t w = 0;
+
+	for (size_t k = 0; k < values; ++k) {
+		__m256i v = _mm256_loadu_si256(
+			(const __m256i *) (deltas + k * DARR_PACKED_LANES));
+
+		acc = _mm256_or_si256(
+			acc,
+			_mm256_sll_epi64(v, _mm_cvtsi32_si128(shift)));
+		shift += bits;
+
+		if (shift >= 64) {
+			_mm256_storeu_si256(
+				(__m256i *) (words + w * DARR_PACKED_LANES),
+				acc);
+			w += 1;
+			shift -= 64;
+
+			// Bits that did not fit start the next word.
+			acc = shift == 0
+				? _mm256_setzero_si256()
+				: _mm256_srl_epi64(
+					v,
+					_mm_cvtsi32_si128(bits - shift));
+		}
+	}
+
+	if (shift > 0) {
+		_mm256_storeu_si256(
+			(__m256i *) (words + w * DARR_PACKED_LANES),
+			acc);
+	}
+}
+
+DARR_CPU_TARGET("avx2")
+static void darr_packed_decode_avx2(
+	const uint64_t *words,
+	unsigned bits,
+	uint64_t base,
+	uint64_t *values)
+{
+	const size_t lanes = DARR_PACKED_LANES;
+	size_t count = DARR_PACKED_BLOCK / DARR_PACKED_LANES;
+	size_t words_count = darr_packed_block_words(bits) / DARR_PACKED_LANES;
+	uint64_t mask = bits == 64 ? ~UINT64_C(0) : (UINT64_C(1) << bits) - 1;
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i vmask = _mm256_set1_epi64x((long long) mask);
+	__m256i carry = _mm256_set1_epi64x((long long) base);
+	__m256i cur = _mm256_loadu_si256((const __m256i *) words);
+	unsigned shift = 0;
+	size_t w = 0;
+
+	for (size_t k = 0; k < count; ++k) {
+		__m256i v = _mm256_srl_epi64(cur, _mm_cvtsi32_si128(shift));
+
+		if (shift + bits > 64) {
+			__m256i next = _mm256_loadu_si256(
+				(const __m256i *) (words + (w + 1) * lanes));
+			__m256i high = _mm256_sll_epi64(
+				next,
+				_mm_cvtsi32_si128(64 - shift));
+			v = _mm256_or_si256(v, high);
+		}
+
+		v = _mm256_and_si256(v, vmask);
+		shift += bits;
+
+		if (shift >= 64) {
+			w += 1;
+			shift -= 64;
+			cur = w < words_count
+				? _mm256_loadu_si256(
+					(const __m256i *) (words + w * lanes))
+				: zero;
+		}
+
+		// Prefix sum of the 4 differences, then the last value of the
+		// previous 4 is added to all of them.
+		v = _mm256_add_epi64(v, _mm256_blend_epi32(
+			_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)),
+			zero,
+			0x03));
+		v = _mm256_add_epi64(v, _mm256_blend_epi32(
+			_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0)),
+			zero,
+			0x0f));
+		v = _mm256_add_epi64(v, carry);
+
+		_mm256_storeu_si256(
+			(__m256i *) (values + k * DARR_PACKED_LANES),
+			v);
+		carry = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+}
+
+#define DARR_PACKED_AVX2(name) name##_avx2
+#else
+#define DARR_PACKED_AVX2(name) name##_scalar
+#endif
+
+static void (*const darr_packed_encode_kernels[DARR_CPU_LEVELS])(
+	const uint64_t *,
+	unsigned,
+	uint64_t *) = {
+	darr_packed_encode_scalar,
+	darr_packed_encode_scalar,
+	darr_packed_encode_scalar,
+	DARR_PACKED_AVX2(darr_packed_encode),
+};
+
+static void (*const darr_packed_decode_kernels[DARR_CPU_LEVELS])(
+	const uint64_t *,
+	unsigned,
+	uint64_t,
+	uint64_t *) = {
+	darr_packed_decode_scalar,
+	darr_packed_decode_scalar,
+	darr_packed_decode_scalar,
+	DARR_PACKED_AVX2(darr_packed_decode),
+};
+
+/*
+ * Unpacks the 128 values of a block.
+ */
+static void darr_packed_decode_block(
+	const struct darr_packed_block *block,
+	const uint64_t *words,
+	uint64_t *values)
+{
+	if (block->bits == 0) {
+		for (size_t i = 0; i < DARR_PACKED_BLOCK; ++i) {
+			values[i] = block->base;
+		}
+
+		return;
+	}
+
+	darr_packed_decode_kernels[darr_cpu_active](
+		words,
+		block->bits,
+		block->base,
+		values);
+}
+
+/*
+ * Packs the values of the tail into a new block and empties the tail.
+ */
+static int darr_packed_flush(struct darr_packed *p)
+{
+	uint64_t deltas[DARR_PACKED_BLOCK];
+	uint64_t any = 0;
+
+	deltas[0] = 0;
+
+	for (size_t i = 1; i < DARR_PACKED_BLOCK; ++i) {
+		deltas[i] = p->tail[i] - p->tail[i - 1];
+		any |= deltas[i];
+	}
+
+	struct darr_packed_block block;
+	block.base = p->tail[0];
+	block.offset = darr_size(&p->words);
+	block.bits = any == 0 ? 0 : 64 - __builtin_clzll(any);
+
+	size_t words = darr_packed_block_words(block.bits);
+
+	if (!darr_grow(&p->words, words)) {
+		return 0;
+	}
+
+	if (!darr_grow(&p->blocks, 1)) {
+		darr_shrink(&p->words, words);
+		return 0;
+	}
+
+	if (words > 0) {
+		uint64_t *out = darr_element(&p->words, block.offset);
+		memset(out, 0, words * sizeof(uint64_t));
+		darr_packed_encode_kernels[darr_cpu_active](
+			deltas,
+			block.bits,
+			out);
+	}
+
+	memcpy(darr_last(&p->blocks), &block, sizeof(block));
+	p->tail_size = 0;
+	return 1;
+}
+
+int darr_packed_push(struct darr_packed *p, uint64_t value)
+{
+	// The tail still holds the values of the last block right after it is
+	// packed, so the last value is always found there.
+	size_t last = p->tail_size == 0 ? DARR_PACKED_BLOCK - 1 : p->tail_size - 1;
+
+	if (p->size > 0 && value < p->tail[last]) {
+		return 0;
+	}
+
+	p->tail[p->tail_size] = value;
+	p->tail_size += 1;
+
+	if (p->tail_size == DARR_PACKED_BLOCK && !darr_packed_flush(p)) {
+		p->tail_size -= 1;
+		return 0;
+	}
+
+	p->size += 1;
+	return 1;
+}
+
+int darr_packed_append_view(struct darr_packed *p, struct darr_view v)
+{
+	const uint64_t *values = darr_view_data(v);
+
+	for (size_t i = 0; i < darr_view_size(v); ++i) {
+		if (!darr_packed_push(p, values[i])) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+uint64_t darr_packed_get(const struct darr_packed *p, size_t i)
+{
+	size_t packed = darr_size(&p->blocks) * DARR_PACKED_BLOCK;
+
+	if (i >= packed) {
+		return p->tail[i - packed];
+	}
+
+	const struct darr_packed_block *block =
+		darr_element_const(&p->blocks, i / DARR_PACKED_BLOCK);
+	const uint64_t *words = darr_data_const(&p->words);
+	uint64_t values[DARR_PACKED_BLOCK];
+
+	darr_packed_decode_block(block, words + block->offset, values);
+	return values[i % DARR_PACKED_BLOCK];
+}
+
+int darr_packed_decode(const struct darr_packed *p, struct darr *d)
+{
+	if (!darr_resize(d, p->size)) {
+		return 0;
+	}
+
+	uint64_t *out = darr_data(d);
+	const struct darr_packed_block *blocks = darr_data_const(&p->blocks);
+	const uint64_t *words = darr_data_const(&p->words);
+
+	for (size_t b = 0; b < darr_size(&p->blocks); ++b) {
+		darr_packed_decode_block(
+			&blocks[b],
+			words + blocks[b].offset,
+			out + b * DARR_PACKED_BLOCK);
+	}
+
+	if (p->tail_size > 0) {
+		memcpy(
+			out + darr_size(&p->blocks) * DARR_PACKED_BLOCK,
+			p->tail,
+			p->tail_size * sizeof(uint64_t));
+	}
+
+	return 1;
+}
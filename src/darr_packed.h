@@ -0,0 +1,132 @@
+#ifndef DARR_DARR_PACKED_H
+#define DARR_DARR_PACKED_H
+
+#include <stdint.h>
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Number of values in a packed block.
+ */
+#define DARR_PACKED_BLOCK 128
+
+/*
+ * Describes a packed block of values.
+ *
+ * base is the first value of the block. The others are stored as the
+ * differences between consecutive values, each using bits bits, starting at
+ * word offset of the packed words.
+ */
+struct darr_packed_block {
+	uint64_t base;
+	size_t offset;
+	unsigned bits;
+};
+
+/*
+ * A compressed array of sorted 64 bit unsigned integers. Values can only be
+ * added at the end and must never be smaller than the last one.
+ *
+ * Values are grouped in blocks of 128. Each block stores the differences
+ * between consecutive values with just enough bits for the largest one, so
+ * arrays whose values are close together take a fraction of the 8 bytes per
+ * value that a struct darr would. The values of the last block are kept
+ * unpacked until the block is full.
+ *
+ * Differences are interleaved in 4 lanes so that blocks are packed and
+ * unpacked 4 values at a time with AVX2 when the CPU supports it.
+ *
+ * You can initialize it by calling darr_packed_init.
+ */
+struct darr_packed {
+	size_t size;
+	struct darr blocks;
+	struct darr words;
+	size_t tail_size;
+	uint64_t tail[DARR_PACKED_BLOCK];
+};
+
+/*
+ * Initializes an empty darr_packed struct.
+ *
+ * Call darr_packed_deinit to deinitialize.
+ */
+inline void darr_packed_init(struct darr_packed *p)
+{
+	p->size = 0;
+	p->tail_size = 0;
+	darr_init(&p->blocks, sizeof(struct darr_packed_block));
+	darr_init(&p->words, sizeof(uint64_t));
+}
+
+/*
+ * Deinitializes a darr_packed struct.
+ */
+inline void darr_packed_deinit(struct darr_packed *p)
+{
+	darr_deinit(&p->blocks);
+	darr_deinit(&p->words);
+}
+
+/*
+ * Returns the number of values.
+ */
+inline size_t darr_packed_size(const struct darr_packed *p)
+{
+	return p->size;
+}
+
+/*
+ * Returns the number of bytes taken by the packed blocks and their
+ * descriptions. Does not include the unpacked values of the last block.
+ */
+inline size_t darr_packed_bytes(const struct darr_packed *p)
+{
+	return darr_data_size(&p->blocks) + darr_data_size(&p->words);
+}
+
+/*
+ * Adds a value to the end. It must not be smaller than the last value.
+ *
+ * Returns 1 on success, 0 on failure. Fails if the value is smaller than the
+ * last one.
+ *
+ * On failure the array remains untouched.
+ */
+int darr_packed_push(struct darr_packed *p, uint64_t value);
+
+/*
+ * Adds every value of a view of uint64_t elements to the end. The values must
+ * be sorted and not smaller than the last value of the array.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the values that come before the one that could not be added
+ * remain added.
+ */
+int darr_packed_append_view(struct darr_packed *p, struct darr_view v);
+
+/*
+ * Returns the value at index i. Unpacks the block that holds it.
+ */
+uint64_t darr_packed_get(const struct darr_packed *p, size_t i);
+
+/*
+ * Replaces the elements of an array of uint64_t with all values, unpacking
+ * one block at a time.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array remains untouched.
+ */
+int darr_packed_decode(const struct darr_packed *p, struct darr *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_PACKED_H */
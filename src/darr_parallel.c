@@ -0,0 +1,516 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "darr_parallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define DARR_PARALLEL_MAX_THREADS 64
+
+#define DARR_PARALLEL_CACHE_LINE 64
+
+/*
+ * Number of chunks an array is split into when the grain is 0.
+ */
+#define DARR_PARALLEL_AUTO_CHUNKS 256
+
+/*
+ * Number of bytes each thread moves at a time in darr_parallel_data_move.
+ */
+#define DARR_PARALLEL_MOVE_GRAIN ((size_t) 1 << 20)
+
+/*
+ * A parallel call. Each kind of call embeds this struct as its first member
+ * and run casts it back.
+ */
+struct darr_parallel_task {
+	size_t size;
+	size_t chunk_size;
+	size_t chunks;
+	void (*run)(
+		struct darr_parallel_task *t,
+		size_t worker,
+		size_t start,
+		size_t count);
+};
+
+/*
+ * The chunks of a task that were given to one thread. Other threads take
+ * from the same counter once they run out of their own chunks.
+ */
+struct darr_parallel_range {
+	_Alignas(DARR_PARALLEL_CACHE_LINE) atomic_size_t next;
+	size_t end;
+};
+
+static struct darr_parallel_pool {
+	// Held for the whole duration of a call so that calls take turns.
+	pthread_mutex_t submit;
+
+	// Protects the fields below it.
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t idle;
+	struct darr_parallel_task *task;
+	unsigned long generation;
+	size_t busy;
+	int stop;
+
+	size_t threads_wanted;
+	size_t count;
+	pthread_t threads[DARR_PARALLEL_MAX_THREADS];
+	struct darr_parallel_range ranges[DARR_PARALLEL_MAX_THREADS];
+} darr_parallel_pool = {
+	.submit = PTHREAD_MUTEX_INITIALIZER,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.wake = PTHREAD_COND_INITIALIZER,
+	.idle = PTHREAD_COND_INITIALIZER,
+};
+
+/*
+ * Set on the threads of the pool and on a thread while it takes part in a
+ * call so that calls made from callbacks do not wait on the pool.
+ */
+static _Thread_local int darr_parallel_inside;
+
+/*
+ * Runs chunks until there are none left, starting with the range of the
+ * given worker and then taking from the ranges of the others.
+ */
+static void darr_parallel_work(
+	struct darr_parallel_task *t,
+	size_t worker,
+	size_t workers)
+{
+	struct darr_parallel_pool *p = &darr_parallel_pool;
+
+	for (size_t k = 0; k < workers; ++k) {
+		struct darr_parallel_range *r = &p->ranges[(worker + k) % workers];
+
+		for (;;) {
+			size_t c = atomic_fetch_add_explicit(
+				&r->next,
+				1,
+				memory_order_relaxed);
+
+			if (c >= r->end) {
+				break;
+			}
+
+			size_t start = c * t->chunk_size;
+			size_t count = t->size - start < t->chunk_size
+				? t->size - start
+				: t->chunk_size;
+			t->run(t, worker, start, count);
+		}
+	}
+}
+
+static void *darr_parallel_thread(void *arg)
+{
+	struct darr_parallel_pool *p = &darr_parallel_pool;
+	size_t worker = (size_t) arg;
+
+	// The generation is reset when the pool starts, before any thread of
+	// the pool can see it, so no task is missed.
+	unsigned long seen = 0;
+
+	darr_parallel_inside = 1;
+
+	pthread_mutex_lock(&p->lock);
+
+	for (;;) {
+		while (!p->stop && p->generation == seen) {
+			pthread_cond_wait(&p->wake, &p->lock);
+		}
+
+		if (p->stop) {
+			break;
+		}
+
+		seen = p->generation;
+		struct darr_parallel_task *t = p->task;
+		size_t workers = p->count + 1;
+		pthread_mutex_unlock(&p->lock);
+
+		darr_parallel_work(t, worker, workers);
+
+		pthread_mutex_lock(&p->lock);
+
+		p->busy -= 1;
+
+		if (p->busy == 0) {
+			pthread_cond_signal(&p->idle);
+		}
+	}
+
+	pthread_mutex_unlock(&p->lock);
+	return NULL;
+}
+
+/*
+ * Starts the threads of the pool if they are not running. The caller must
+ * hold the submit lock.
+ *
+ * If threads fail to start, the pool runs with fewer of them.
+ */
+static void darr_parallel_start(void)
+{
+	struct darr_parallel_pool *p = &darr_parallel_pool;
+
+	if (p->count > 0) {
+		return;
+	}
+
+	size_t threads = p->threads_wanted;
+
+	if (threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0 ? (size_t) online : 1;
+	}
+
+	if (threads > DARR_PARALLEL_MAX_THREADS) {
+		threads = DARR_PARALLEL_MAX_THREADS;
+	}
+
+	p->stop = 0;
+	p->generation = 0;
+
+	// The calling thread is one of them.
+	for (size_t i = 1; i < threads; ++i) {
+		if (pthread_create(
+			&p->threads[p->count],
+			NULL,
+			darr_parallel_thread,
+			(void *) i) != 0) {
+			break;
+		}
+
+		p->count += 1;
+	}
+}
+
+/*
+ * Stops the threads of the pool. The caller must hold the submit lock.
+ */
+static void darr_parallel_stop(void)
+{
+	struct darr_parallel_pool *p = &darr_parallel_pool;
+
+	pthread_mutex_lock(&p->lock);
+	p->stop = 1;
+	pthread_cond_broadcast(&p->wake);
+	pthread_mutex_unlock(&p->lock);
+
+	for (size_t i = 0; i < p->count; ++i) {
+		pthread_join(p->threads[i], NULL);
+	}
+
+	p->count = 0;
+}
+
+void darr_parallel_threads_set(size_t threads)
+{
+	struct darr_parallel_pool *p = &darr_parallel_pool;
+
+	pthread_mutex_lock(&p->submit);
+	darr_parallel_stop();
+	p->threads_wanted = threads;
+	pthread_mutex_unlock(&p->submit);
+}
+
+void darr_parallel_shutdown(void)
+{
+	struct darr_parallel_pool *p = &darr_parallel_pool;
+
+	pthread_mutex_lock(&p->submit);
+	darr_parallel_stop();
+	pthread_mutex_unlock(&p->submit);
+}
+
+/*
+ * Splits a task into chunks of at least grain elements of element_size bytes
+ * that span whole cache lines.
+ */
+static void darr_parallel_split(
+	struct darr_parallel_task *t,
+	size_t size,
+	size_t element_size,
+	size_t grain)
+{
+	if (grain == 0) {
+		grain = size / DARR_PARALLEL_AUTO_CHUNKS;
+	}
+
+	// The smallest number of elements whose bytes are a multiple of the
+	// cache line size.
+	size_t line = DARR_PARALLEL_CACHE_LINE;
+	size_t a = line;
+	size_t b = element_size > 0 ? element_size : 1;
+
+	while (b != 0) {
+		size_t r = a % b;
+		a = b;
+		b = r;
+	}
+
+	size_t step = line / a;
+
+	t->size = size;
+	t->chunk_size = grain > step ? (grain + step - 1) / step * step : step;
+	t->chunks = (size + t->chunk_size - 1) / t->chunk_size;
+}
+
+/*
+ * Runs a task on the pool, or on the calling thread alone if it has a single
+ * chunk or the call comes from inside another one.
+ */
+static void darr_parallel_run(struct darr_parallel_task *t)
+{
+	struct darr_parallel_pool *p = &darr_parallel_pool;
+
+	if (t->chunks <= 1 || darr_parallel_inside) {
+		for (size_t start = 0; start < t->size; start += t->chunk_size) {
+			size_t count = t->size - start < t->chunk_size
+				? t->size - start
+				: t->chunk_size;
+			t->run(t, 0, start, count);
+		}
+
+		return;
+	}
+
+	pthread_mutex_lock(&p->submit);
+	darr_parallel_start();
+
+	size_t workers = p->count + 1;
+
+	for (size_t w = 0; w < workers; ++w) {
+		atomic_store_explicit(
+			&p->ranges[w].next,
+			t->chunks * w / workers,
+			memory_order_relaxed);
+		p->ranges[w].end = t->chunks * (w + 1) / workers;
+	}
+
+	pthread_mutex_lock(&p->lock);
+	p->task = t;
+	p->generation += 1;
+	p->busy = p->count;
+	pthread_cond_broadcast(&p->wake);
+	pthread_mutex_unlock(&p->lock);
+
+	darr_parallel_inside = 1;
+	darr_parallel_work(t, 0, workers);
+	darr_parallel_inside = 0;
+
+	pthread_mutex_lock(&p->lock);
+
+	while (p->busy > 0) {
+		pthread_cond_wait(&p->idle, &p->lock);
+	}
+
+	p->task = NULL;
+	pthread_mutex_unlock(&p->lock);
+
+	pthread_mutex_unlock(&p->submit);
+}
+
+struct darr_parallel_for_task {
+	struct darr_parallel_task base;
+	darr_parallel_for_t fn;
+	void *ctx;
+	struct darr *d;
+};
+
+static void darr_parallel_for_run(
+	struct darr_parallel_task *t,
+	size_t worker,
+	size_t start,
+	size_t count)
+{
+	struct darr_parallel_for_task *f = (struct darr_parallel_for_task *) t;
+	(void) worker;
+	f->fn(f->ctx, darr_element(f->d, start), start, count);
+}
+
+void darr_parallel_for(
+	struct darr *d,
+	darr_parallel_for_t fn,
+	void *ctx,
+	size_t grain)
+{
+	struct darr_parallel_for_task f;
+	darr_parallel_split(&f.base, darr_size(d), d->element_size, grain);
+	f.base.run = darr_parallel_for_run;
+	f.fn = fn;
+	f.ctx = ctx;
+	f.d = d;
+
+	darr_parallel_run(&f.base);
+}
+
+struct darr_parallel_reduce_task {
+	struct darr_parallel_task base;
+	darr_parallel_reduce_t reduce;
+	void *ctx;
+	const struct darr *d;
+	struct darr *partials;
+};
+
+static void darr_parallel_reduce_run(
+	struct darr_parallel_task *t,
+	size_t worker,
+	size_t start,
+	size_t count)
+{
+	struct darr_parallel_reduce_task *r =
+		(struct darr_parallel_reduce_task *) t;
+	r->reduce(
+		r->ctx,
+		darr_element(r->partials, worker),
+		darr_element_const(r->d, start),
+		start,
+		count);
+}
+
+int darr_parallel_reduce(
+	const struct darr *d,
+	darr_parallel_reduce_t reduce,
+	darr_parallel_combine_t combine,
+	void *ctx,
+	void *result,
+	size_t result_size,
+	size_t grain)
+{
+	// Every thread folds into its own copy of the identity. Copies are
+	// padded to whole cache lines so that threads do not write to the same
+	// line.
+	size_t line = DARR_PARALLEL_CACHE_LINE;
+	size_t stride = (result_size + line - 1) / line * line;
+
+	struct darr partials;
+	darr_init_aligned(&partials, stride > 0 ? stride : line, line, 0);
+
+	if (!darr_resize(&partials, DARR_PARALLEL_MAX_THREADS)) {
+		return 0;
+	}
+
+	for (size_t w = 0; w < DARR_PARALLEL_MAX_THREADS; ++w) {
+		memcpy(darr_element(&partials, w), result, result_size);
+	}
+
+	struct darr_parallel_reduce_task r;
+	darr_parallel_split(&r.base, darr_size(d), d->element_size, grain);
+	r.base.run = darr_parallel_reduce_run;
+	r.reduce = reduce;
+	r.ctx = ctx;
+	r.d = d;
+	r.partials = &partials;
+
+	darr_parallel_run(&r.base);
+
+	// Copies of threads that processed no chunks still hold the identity
+	// and combining them changes nothing.
+	for (size_t w = 0; w < DARR_PARALLEL_MAX_THREADS; ++w) {
+		combine(ctx, result, darr_element(&partials, w));
+	}
+
+	darr_deinit(&partials);
+	return 1;
+}
+
+struct darr_parallel_transform_task {
+	struct darr_parallel_task base;
+	darr_parallel_transform_t fn;
+	void *ctx;
+	struct darr *dst;
+	const struct darr *src;
+};
+
+static void darr_parallel_transform_run(
+	struct darr_parallel_task *t,
+	size_t worker,
+	size_t start,
+	size_t count)
+{
+	struct darr_parallel_transform_task *x =
+		(struct darr_parallel_transform_task *) t;
+	(void) worker;
+	x->fn(
+		x->ctx,
+		darr_element(x->dst, start),
+		darr_element_const(x->src, start),
+		start,
+		count);
+}
+
+int darr_parallel_transform(
+	struct darr *dst,
+	const struct darr *src,
+	darr_parallel_transform_t fn,
+	void *ctx,
+	size_t grain)
+{
+	if (!darr_resize(dst, darr_size(src))) {
+		return 0;
+	}
+
+	struct darr_parallel_transform_task x;
+	darr_parallel_split(&x.base, darr_size(src), dst->element_size, grain);
+	x.base.run = darr_parallel_transform_run;
+	x.fn = fn;
+	x.ctx = ctx;
+	x.dst = dst;
+	x.src = src;
+
+	darr_parallel_run(&x.base);
+	return 1;
+}
+
+struct darr_parallel_move_task {
+	struct darr_parallel_task base;
+	char *dst;
+	const char *src;
+};
+
+static void darr_parallel_move_run(
+	struct darr_parallel_task *t,
+	size_t worker,
+	size_t start,
+	size_t count)
+{
+	struct darr_parallel_move_task *m = (struct darr_parallel_move_task *) t;
+	(void) worker;
+	darr_data_move_stream(m->dst + start, m->src + start, count);
+}
+
+void darr_parallel_data_move(void *dst, const void *src, size_t bytes)
+{
+	char *d = dst;
+	const char *s = src;
+	size_t distance = d < s ? (size_t) (s - d) : (size_t) (d - s);
+	size_t round = distance < bytes ? distance : bytes;
+
+	if (round < DARR_PARALLEL_MOVE_GRAIN * 2) {
+		darr_data_move_stream(dst, src, bytes);
+		return;
+	}
+
+	// Within a round the bytes that are written and the bytes that are read
+	// do not overlap. Rounds go in the same direction as memmove so that
+	// every round only overwrites bytes that earlier rounds have read.
+	for (size_t done = 0; done < bytes; done += round) {
+		size_t size = bytes - done < round ? bytes - done : round;
+		size_t offset = d < s ? done : bytes - done - size;
+
+		struct darr_parallel_move_task m;
+		darr_parallel_split(&m.base, size, 1, DARR_PARALLEL_MOVE_GRAIN);
+		m.base.run = darr_parallel_move_run;
+		m.dst = d + offset;
+		m.src = s + offset;
+
+		darr_parallel_run(&m.base);
+	}
+}
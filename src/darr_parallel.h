@@ -0,0 +1,153 @@
+#ifndef DARR_DARR_PARALLEL_H
+#define DARR_DARR_PARALLEL_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The parallel functions split the elements of an array into chunks and hand
+ * them to a pool of threads. Every chunk is processed by a single call of the
+ * callback with a pointer to its first element, the index of that element
+ * and the number of elements in the chunk.
+ *
+ * The chunks are divided evenly between the threads. A thread that runs out
+ * of chunks takes chunks that other threads have not started yet, so that
+ * elements that take longer to process do not leave threads idle.
+ *
+ * The number of elements in a chunk is the grain rounded up so that chunks
+ * span a whole number of 64 byte cache lines. A grain of 0 lets the library
+ * choose. Chunks of arrays initialized with darr_init_aligned and an
+ * alignment of 64 therefore never share a cache line.
+ *
+ * The pool is started by the first call and its threads wait for work
+ * between calls. Calls from different threads take turns. Calls made from
+ * inside a callback run on the calling thread only.
+ */
+
+/*
+ * Called by darr_parallel_for for every chunk.
+ */
+typedef void (*darr_parallel_for_t)(
+	void *ctx,
+	void *elements,
+	size_t start,
+	size_t count);
+
+/*
+ * Called by darr_parallel_reduce for every chunk. Must fold the elements into
+ * the partial result pointed to by acc.
+ */
+typedef void (*darr_parallel_reduce_t)(
+	void *ctx,
+	void *acc,
+	const void *elements,
+	size_t start,
+	size_t count);
+
+/*
+ * Called by darr_parallel_reduce to fold the partial result pointed to by
+ * other into the one pointed to by acc.
+ */
+typedef void (*darr_parallel_combine_t)(
+	void *ctx,
+	void *acc,
+	const void *other);
+
+/*
+ * Called by darr_parallel_transform for every chunk. Must write count
+ * elements to dst computed from the count elements at src.
+ */
+typedef void (*darr_parallel_transform_t)(
+	void *ctx,
+	void *dst,
+	const void *src,
+	size_t start,
+	size_t count);
+
+/*
+ * Sets the number of threads that take part in parallel calls, including the
+ * thread making the call. 0 uses one thread per online processor, which is
+ * also the default. At most 64 threads are used.
+ *
+ * Stops the pool if it is running. It starts again with the new number of
+ * threads on the next call.
+ */
+void darr_parallel_threads_set(size_t threads);
+
+/*
+ * Stops the threads of the pool. Call this before the program exits if the
+ * threads must not outlive it, such as when checking for leaks.
+ */
+void darr_parallel_shutdown(void);
+
+/*
+ * Calls fn for every chunk of elements of the array.
+ */
+void darr_parallel_for(
+	struct darr *d,
+	darr_parallel_for_t fn,
+	void *ctx,
+	size_t grain);
+
+/*
+ * Reduces the elements of the array to a single value of result_size bytes.
+ *
+ * result must hold the identity of the reduction when called and receives
+ * the final value. Each thread starts with a copy of the identity, folds its
+ * chunks into it with reduce and the copies are then folded into result with
+ * combine. The order in which chunks and copies are folded is unspecified,
+ * so the reduction must be associative and commutative.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure result remains untouched.
+ */
+int darr_parallel_reduce(
+	const struct darr *d,
+	darr_parallel_reduce_t reduce,
+	darr_parallel_combine_t combine,
+	void *ctx,
+	void *result,
+	size_t result_size,
+	size_t grain);
+
+/*
+ * Resizes dst to the size of src and calls fn for every chunk of elements of
+ * src with the matching elements of dst. Chunks are sized after the elements
+ * of dst.
+ *
+ * dst and src may be the same array.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure dst remains untouched.
+ */
+int darr_parallel_transform(
+	struct darr *dst,
+	const struct darr *src,
+	darr_parallel_transform_t fn,
+	void *ctx,
+	size_t grain);
+
+/*
+ * Moves bytes from src to dst like memmove, splitting the move between the
+ * threads of the pool. Each thread writes with darr_data_move_stream.
+ *
+ * Overlapping moves are done in rounds of as many bytes as the distance
+ * between dst and src, one after the other, so that no thread overwrites
+ * bytes another has yet to read. Moves where that distance is too short to
+ * split between threads are done on the calling thread alone.
+ *
+ * Pass it to darr_global_data_move_set so that shifting very large arrays
+ * uses the pool.
+ */
+void darr_parallel_data_move(void *dst, const void *src, size_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_PARALLEL_H */
@@ -0,0 +1,411 @@
+#include "darr_pvec.h"
+
+#include <stdatomic.h>
+
+#define DARR_PVEC_MASK (DARR_PVEC_WIDTH - 1)
+
+extern inline void darr_pvec_init(struct darr_pvec *v, size_t element_size);
+
+extern inline size_t darr_pvec_size(const struct darr_pvec *v);
+
+/*
+ * A node of the tree. Nodes at shift 0 are leaves and hold elements, the
+ * others hold pointers to their children. Children past the end of the
+ * array are NULL.
+ *
+ * Leaves are allocated with room for DARR_PVEC_WIDTH elements, which may be
+ * less than the size of the struct.
+ */
+struct darr_pvec_node {
+	atomic_size_t refs;
+	union {
+		struct darr_pvec_node *children[DARR_PVEC_WIDTH];
+		max_align_t align;
+	} u;
+};
+
+static size_t darr_pvec_node_bytes(const struct darr_pvec *v, unsigned shift)
+{
+	size_t header = offsetof(struct darr_pvec_node, u);
+
+	if (shift > 0) {
+		return sizeof(struct darr_pvec_node);
+	}
+
+	return header + DARR_PVEC_WIDTH * v->element_size;
+}
+
+static char *darr_pvec_elements(struct darr_pvec_node *n)
+{
+	return (char *) &n->u;
+}
+
+/*
+ * Allocates a node with a single reference. The children of inner nodes are
+ * set to NULL.
+ */
+static struct darr_pvec_node *darr_pvec_node_new(
+	const struct darr_pvec *v,
+	unsigned shift)
+{
+	struct darr_pvec_node *n = darr_mem_realloc(
+		NULL,
+		darr_pvec_node_bytes(v, shift));
+
+	if (n == NULL) {
+		return NULL;
+	}
+
+	atomic_init(&n->refs, 1);
+
+	if (shift > 0) {
+		memset(n->u.children, 0, sizeof(n->u.children));
+	}
+
+	return n;
+}
+
+static void darr_pvec_node_retain(struct darr_pvec_node *n)
+{
+	atomic_fetch_add_explicit(&n->refs, 1, memory_order_relaxed);
+}
+
+/*
+ * Drops a reference to a node and frees it and its children once there are
+ * none left.
+ */
+static void darr_pvec_node_release(struct darr_pvec_node *n, unsigned shift)
+{
+	if (n == NULL
+		|| atomic_fetch_sub_explicit(&n->refs, 1, memory_order_acq_rel)
+			!= 1) {
+		return;
+	}
+
+	if (shift > 0) {
+		for (size_t i = 0; i < DARR_PVEC_WIDTH; ++i) {
+			darr_pvec_node_release(
+				n->u.children[i],
+				shift - DARR_PVEC_BITS);
+		}
+	}
+
+	darr_mem_free(n);
+}
+
+/*
+ * Makes sure that the node in slot is referenced only by its parent, or by
+ * the version if it is the root, by replacing it with a copy if it is shared.
+ * Creates the node if the slot is empty.
+ *
+ * Returns 1 on success, 0 on failure. On failure the slot is untouched.
+ */
+static int darr_pvec_own(
+	const struct darr_pvec *v,
+	struct darr_pvec_node **slot,
+	unsigned shift)
+{
+	struct darr_pvec_node *n = *slot;
+
+	if (n != NULL
+		&& atomic_load_explicit(&n->refs, memory_order_acquire) == 1) {
+		return 1;
+	}
+
+	struct darr_pvec_node *copy = darr_pvec_node_new(v, shift);
+
+	if (copy == NULL) {
+		return 0;
+	}
+
+	if (n != NULL) {
+		memcpy(&copy->u, &n->u, darr_pvec_node_bytes(v, shift)
+			- offsetof(struct darr_pvec_node, u));
+
+		if (shift > 0) {
+			for (size_t i = 0; i < DARR_PVEC_WIDTH; ++i) {
+				if (copy->u.children[i] != NULL) {
+					darr_pvec_node_retain(copy->u.children[i]);
+				}
+			}
+		}
+
+		darr_pvec_node_release(n, shift);
+	}
+
+	*slot = copy;
+	return 1;
+}
+
+void darr_pvec_deinit(struct darr_pvec *v)
+{
+	darr_pvec_node_release(v->root, v->shift);
+	v->root = NULL;
+	v->size = 0;
+	v->shift = 0;
+}
+
+void darr_pvec_copy(struct darr_pvec *out, const struct darr_pvec *v)
+{
+	*out = *v;
+
+	if (out->root != NULL) {
+		darr_pvec_node_retain(out->root);
+	}
+}
+
+/*
+ * Returns the leaf that holds the element at index i.
+ */
+static struct darr_pvec_node *darr_pvec_leaf(
+	const struct darr_pvec *v,
+	size_t i)
+{
+	struct darr_pvec_node *n = v->root;
+
+	for (unsigned s = v->shift; s > 0; s -= DARR_PVEC_BITS) {
+		n = n->u.children[(i >> s) & DARR_PVEC_MASK];
+	}
+
+	return n;
+}
+
+const void *darr_pvec_get(const struct darr_pvec *v, size_t i)
+{
+	struct darr_pvec_node *leaf = darr_pvec_leaf(v, i);
+	return darr_pvec_elements(leaf) + (i & DARR_PVEC_MASK) * v->element_size;
+}
+
+/*
+ * Takes ownership of every node on the path to index i, creating missing
+ * ones, and returns the address of the element in its leaf.
+ *
+ * On failure returns NULL. Nodes that were already copied stay in place,
+ * which leaves the elements of the version untouched.
+ */
+static char *darr_pvec_path(struct darr_pvec *v, size_t i)
+{
+	struct darr_pvec_node **slot = &v->root;
+
+	for (unsigned s = v->shift; ; s -= DARR_PVEC_BITS) {
+		if (!darr_pvec_own(v, slot, s)) {
+			return NULL;
+		}
+
+		if (s == 0) {
+			break;
+		}
+
+		slot = &(*slot)->u.children[(i >> s) & DARR_PVEC_MASK];
+	}
+
+	return darr_pvec_elements(*slot) + (i & DARR_PVEC_MASK) * v->element_size;
+}
+
+int darr_pvec_transient_set(struct darr_pvec *v, size_t i, const void *e)
+{
+	// The path to an index past the size would create nodes outside the
+	// version, or wrap around to another element past the capacity of the
+	// root.
+	if (i >= v->size) {
+		return 0;
+	}
+
+	char *p = darr_pvec_path(v, i);
+
+	if (p == NULL) {
+		return 0;
+	}
+
+	memcpy(p, e, v->element_size);
+	return 1;
+}
+
+int darr_pvec_transient_push(struct darr_pvec *v, const void *e)
+{
+	// A full tree gets a new root with the old one as its first child.
+	if (v->root != NULL
+		&& v->size >> v->shift >= DARR_PVEC_WIDTH) {
+		struct darr_pvec_node *root = darr_pvec_node_new(
+			v,
+			v->shift + DARR_PVEC_BITS);
+
+		if (root == NULL) {
+			return 0;
+		}
+
+		root->u.children[0] = v->root;
+		v->root = root;
+		v->shift += DARR_PVEC_BITS;
+	}
+
+	char *p = darr_pvec_path(v, v->size);
+
+	if (p == NULL) {
+		return 0;
+	}
+
+	memcpy(p, e, v->element_size);
+	v->size += 1;
+	return 1;
+}
+
+/*
+ * Deinitializes out and moves next into it.
+ */
+static void darr_pvec_replace(struct darr_pvec *out, struct darr_pvec *next)
+{
+	darr_pvec_deinit(out);
+	*out = *next;
+}
+
+int darr_pvec_set(
+	struct darr_pvec *out,
+	const struct darr_pvec *v,
+	size_t i,
+	const void *e)
+{
+	struct darr_pvec next;
+	darr_pvec_copy(&next, v);
+
+	if (!darr_pvec_transient_set(&next, i, e)) {
+		darr_pvec_deinit(&next);
+		return 0;
+	}
+
+	darr_pvec_replace(out, &next);
+	return 1;
+}
+
+int darr_pvec_push(
+	struct darr_pvec *out,
+	const struct darr_pvec *v,
+	const void *e)
+{
+	struct darr_pvec next;
+	darr_pvec_copy(&next, v);
+
+	if (!darr_pvec_transient_push(&next, e)) {
+		darr_pvec_deinit(&next);
+		return 0;
+	}
+
+	darr_pvec_replace(out, &next);
+	return 1;
+}
+
+/*
+ * Drops a reference to each of the given nodes.
+ */
+static void darr_pvec_release_all(
+	struct darr_pvec_node **nodes,
+	size_t count,
+	unsigned shift)
+{
+	for (size_t k = 0; k < count; ++k) {
+		darr_pvec_node_release(nodes[k], shift);
+	}
+}
+
+int darr_pvec_from_darr(struct darr_pvec *out, const struct darr *d)
+{
+	struct darr_pvec next;
+	darr_pvec_init(&next, out->element_size);
+
+	size_t size = darr_size(d);
+
+	if (size == 0) {
+		darr_pvec_replace(out, &next);
+		return 1;
+	}
+
+	// The nodes of the level being built, from left to right. Leaves first
+	// and then each level above them until a single node remains.
+	struct darr level;
+	darr_init(&level, sizeof(struct darr_pvec_node *));
+
+	if (!darr_resize(&level, (size - 1) / DARR_PVEC_WIDTH + 1)) {
+		return 0;
+	}
+
+	struct darr_pvec_node **nodes = darr_data(&level);
+	size_t count = darr_size(&level);
+
+	for (size_t k = 0; k < count; ++k) {
+		nodes[k] = darr_pvec_node_new(&next, 0);
+
+		if (nodes[k] == NULL) {
+			darr_pvec_release_all(nodes, k, 0);
+			darr_deinit(&level);
+			return 0;
+		}
+
+		size_t start = k * DARR_PVEC_WIDTH;
+		size_t n = size - start < DARR_PVEC_WIDTH
+			? size - start
+			: DARR_PVEC_WIDTH;
+
+		memcpy(
+			darr_pvec_elements(nodes[k]),
+			darr_element_const(d, start),
+			n * next.element_size);
+	}
+
+	while (count > 1) {
+		size_t parents = (count - 1) / DARR_PVEC_WIDTH + 1;
+		unsigned shift = next.shift + DARR_PVEC_BITS;
+
+		// Parents overwrite the start of the level as they take its nodes.
+		for (size_t p = 0; p < parents; ++p) {
+			size_t first = p * DARR_PVEC_WIDTH;
+			struct darr_pvec_node *parent = darr_pvec_node_new(&next, shift);
+
+			if (parent == NULL) {
+				darr_pvec_release_all(nodes, p, shift);
+				darr_pvec_release_all(
+					nodes + first,
+					count - first,
+					next.shift);
+				darr_deinit(&level);
+				return 0;
+			}
+
+			size_t n = count - first < DARR_PVEC_WIDTH
+				? count - first
+				: DARR_PVEC_WIDTH;
+
+			memcpy(parent->u.children, nodes + first, n * sizeof(*nodes));
+			nodes[p] = parent;
+		}
+
+		count = parents;
+		next.shift = shift;
+	}
+
+	next.root = nodes[0];
+	next.size = size;
+	darr_deinit(&level);
+
+	darr_pvec_replace(out, &next);
+	return 1;
+}
+
+int darr_pvec_to_darr(struct darr *d, const struct darr_pvec *v)
+{
+	if (!darr_resize(d, v->size)) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < v->size; i += DARR_PVEC_WIDTH) {
+		size_t n = v->size - i < DARR_PVEC_WIDTH
+			? v->size - i
+			: DARR_PVEC_WIDTH;
+
+		memcpy(
+			darr_element(d, i),
+			darr_pvec_elements(darr_pvec_leaf(v, i)),
+			n * v->element_size);
+	}
+
+	return 1;
+}
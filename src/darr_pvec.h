@@ -0,0 +1,163 @@
+#ifndef DARR_DARR_PVEC_H
+#define DARR_DARR_PVEC_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Number of bits of an index consumed by each level of the tree and the
+ * number of children or elements of each node.
+ */
+#define DARR_PVEC_BITS 5
+#define DARR_PVEC_WIDTH (1 << DARR_PVEC_BITS)
+
+struct darr_pvec_node;
+
+/*
+ * A version of a persistent array. Changing an element or adding one creates
+ * a new version and leaves the old one as it was, so any number of versions
+ * of an array can be kept around and read at the same time.
+ *
+ * Elements are kept in a tree where every node has 32 children and the
+ * leaves hold 32 elements each. A new version only copies the nodes on the
+ * path to the element that changed and shares all others with the version
+ * it came from, so it costs a few hundred bytes rather than a copy of the
+ * whole array. Getting, setting and adding an element all visit one node per
+ * level, which is 4 levels for a million elements.
+ *
+ * Nodes count the versions and nodes that point to them and are freed once
+ * there are none. Counts are changed atomically so versions that share nodes
+ * may be read, copied and deinitialized from different threads.
+ *
+ * You can initialize it by calling darr_pvec_init.
+ */
+struct darr_pvec {
+	size_t element_size;
+	size_t size;
+	unsigned shift;
+	struct darr_pvec_node *root;
+};
+
+/*
+ * Initializes an empty version.
+ *
+ * Call darr_pvec_deinit to deinitialize.
+ */
+inline void darr_pvec_init(struct darr_pvec *v, size_t element_size)
+{
+	v->element_size = element_size;
+	v->size = 0;
+	v->shift = 0;
+	v->root = NULL;
+}
+
+/*
+ * Deinitializes a version. Nodes that no other version shares are freed.
+ */
+void darr_pvec_deinit(struct darr_pvec *v);
+
+/*
+ * Returns the number of elements.
+ */
+inline size_t darr_pvec_size(const struct darr_pvec *v)
+{
+	return v->size;
+}
+
+/*
+ * Initializes out as another reference to the same version. Takes constant
+ * time.
+ *
+ * out must not be initialized. Call darr_pvec_deinit on both.
+ */
+void darr_pvec_copy(struct darr_pvec *out, const struct darr_pvec *v);
+
+/*
+ * Returns a pointer to the element at the given index, which must be less
+ * than the size. It remains valid for as long as the version is not
+ * deinitialized or changed in place.
+ */
+const void *darr_pvec_get(const struct darr_pvec *v, size_t i);
+
+/*
+ * The functions below create a new version from v and store it in out,
+ * which must be initialized. The version previously in out is deinitialized.
+ * out may be v.
+ *
+ * Each returns 1 on success, 0 on failure.
+ *
+ * On failure out remains untouched.
+ */
+
+/*
+ * A version where the element at index i is replaced with a copy of e. Fails
+ * if i is not less than the size.
+ */
+int darr_pvec_set(
+	struct darr_pvec *out,
+	const struct darr_pvec *v,
+	size_t i,
+	const void *e);
+
+/*
+ * A version with a copy of e added after the last element.
+ */
+int darr_pvec_push(
+	struct darr_pvec *out,
+	const struct darr_pvec *v,
+	const void *e);
+
+/*
+ * The transient functions below change v in place. They only copy the nodes
+ * that v shares with other versions and then take ownership of the copies,
+ * so a batch of changes to the same version copies each node at most once
+ * instead of once per change.
+ *
+ * The version must not be read by other threads while it is being changed.
+ * Other versions are not affected.
+ *
+ * Each returns 1 on success, 0 on failure.
+ *
+ * On failure the elements of v remain untouched.
+ */
+
+/*
+ * Replaces the element at index i with a copy of e. Fails if i is not less
+ * than the size.
+ */
+int darr_pvec_transient_set(struct darr_pvec *v, size_t i, const void *e);
+
+/*
+ * Adds a copy of e after the last element.
+ */
+int darr_pvec_transient_push(struct darr_pvec *v, const void *e);
+
+/*
+ * Replaces out with a version holding copies of the elements of the array.
+ * The element size of out must be the same as that of the array.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure out remains untouched.
+ */
+int darr_pvec_from_darr(struct darr_pvec *out, const struct darr *d);
+
+/*
+ * Replaces the elements of the array with copies of the elements of the
+ * version. The element size of the array must be the same as that of the
+ * version.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array remains untouched.
+ */
+int darr_pvec_to_darr(struct darr *d, const struct darr_pvec *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_PVEC_H */
@@ -0,0 +1,106 @@
+#include "darr_ring.h"
+
+extern inline void darr_ring_deinit(struct darr_ring *r);
+
+extern inline size_t darr_ring_capacity(const struct darr_ring *r);
+
+extern inline size_t darr_ring_size(const struct darr_ring *r);
+
+int darr_ring_init(struct darr_ring *r, size_t element_size, size_t capacity)
+{
+	// Indexes only ever grow and wrap around past SIZE_MAX, which keeps
+	// positions in the buffer right because a power of two capacity
+	// divides the range of size_t.
+	if (capacity > SIZE_MAX / 2 + 1) {
+		return 0;
+	}
+
+	size_t rounded = 1;
+
+	while (rounded < capacity) {
+		rounded *= 2;
+	}
+
+	darr_init(&r->buffer, element_size);
+
+	if (!darr_resize(&r->buffer, rounded)) {
+		darr_deinit(&r->buffer);
+		return 0;
+	}
+
+	r->head = 0;
+	r->tail_cache = 0;
+	r->tail = 0;
+	r->head_cache = 0;
+	r->mask = rounded - 1;
+
+	return 1;
+}
+
+size_t darr_ring_push(struct darr_ring *r, const void *elements, size_t count)
+{
+	size_t capacity = r->mask + 1;
+	size_t tail = r->tail;
+	size_t room = capacity - (tail - r->head_cache);
+
+	if (room < count) {
+		// The consumer must be done reading the elements before their
+		// room is written.
+		r->head_cache = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+		room = capacity - (tail - r->head_cache);
+	}
+
+	size_t n = count < room ? count : room;
+
+	if (n == 0) {
+		return 0;
+	}
+
+	size_t size = r->buffer.element_size;
+	size_t start = tail & r->mask;
+	size_t first = capacity - start < n ? capacity - start : n;
+
+	memcpy(darr_element(&r->buffer, start), elements, first * size);
+	memcpy(
+		darr_data(&r->buffer),
+		(const char *) elements + first * size,
+		(n - first) * size);
+
+	// Publishes the elements to the consumer.
+	__atomic_store_n(&r->tail, tail + n, __ATOMIC_RELEASE);
+	return n;
+}
+
+size_t darr_ring_pop(struct darr_ring *r, void *out, size_t count)
+{
+	size_t capacity = r->mask + 1;
+	size_t head = r->head;
+	size_t available = r->tail_cache - head;
+
+	if (available < count) {
+		// Makes the elements the producer wrote before moving the tail
+		// visible here.
+		r->tail_cache = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+		available = r->tail_cache - head;
+	}
+
+	size_t n = count < available ? count : available;
+
+	if (n == 0) {
+		return 0;
+	}
+
+	size_t size = r->buffer.element_size;
+	size_t start = head & r->mask;
+	size_t first = capacity - start < n ? capacity - start : n;
+
+	memcpy(out, darr_element(&r->buffer, start), first * size);
+	memcpy(
+		(char *) out + first * size,
+		darr_data(&r->buffer),
+		(n - first) * size);
+
+	// Hands the room back to the producer.
+	__atomic_store_n(&r->head, head + n, __ATOMIC_RELEASE);
+	return n;
+}
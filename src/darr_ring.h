@@ -0,0 +1,126 @@
+#ifndef DARR_DARR_RING_H
+#define DARR_DARR_RING_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The size of a cache line. The indexes that the producer and the consumer
+ * write are kept this far apart so that writing one does not take the line
+ * of the other away from the core that reads it.
+ */
+#define DARR_RING_CACHE_LINE 64
+
+#ifdef __cplusplus
+#define DARR_RING_ALIGNED alignas(DARR_RING_CACHE_LINE)
+#else
+#define DARR_RING_ALIGNED _Alignas(DARR_RING_CACHE_LINE)
+#endif
+
+/*
+ * A queue of elements of a fixed size for passing them from one thread to
+ * another, with one thread adding elements and one thread taking them out.
+ *
+ * The elements are kept in a circular buffer held by a struct darr whose
+ * capacity is a power of two. The producer only ever writes the tail index
+ * and the consumer only ever writes the head index, so neither waits for the
+ * other: darr_ring_push and darr_ring_pop copy as many elements as there are
+ * room or elements for, in at most two contiguous spans each, and return
+ * right away.
+ *
+ * Each side also keeps a copy of the index of the other side and only reads
+ * the real one when the copy says the queue is full or empty, so that a
+ * steady stream of batches touches the cache line of the other side rarely.
+ *
+ * The indexes are plain size_t accessed with the __atomic builtins of GCC
+ * and Clang rather than atomic_size_t from <stdatomic.h>, which C++ cannot
+ * use before C++23. This keeps the struct and darr_ring_size usable from
+ * C++ code.
+ *
+ * You can initialize it by calling darr_ring_init. The struct is aligned to
+ * a cache line, so allocate it with aligned_alloc if it is not a variable.
+ */
+struct darr_ring {
+	/*
+	 * Written by the consumer.
+	 */
+	DARR_RING_ALIGNED size_t head;
+	size_t tail_cache;
+
+	/*
+	 * Written by the producer.
+	 */
+	DARR_RING_ALIGNED size_t tail;
+	size_t head_cache;
+
+	/*
+	 * Never written after initialization.
+	 */
+	DARR_RING_ALIGNED size_t mask;
+	struct darr buffer;
+};
+
+/*
+ * Initializes an empty queue with room for at least capacity elements,
+ * rounded up to a power of two.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * Call darr_ring_deinit to deinitialize.
+ */
+int darr_ring_init(struct darr_ring *r, size_t element_size, size_t capacity);
+
+/*
+ * Deinitializes a queue. No thread may be using it.
+ */
+inline void darr_ring_deinit(struct darr_ring *r)
+{
+	darr_deinit(&r->buffer);
+}
+
+/*
+ * Returns the number of elements the queue can hold.
+ */
+inline size_t darr_ring_capacity(const struct darr_ring *r)
+{
+	return r->mask + 1;
+}
+
+/*
+ * Returns the number of elements in the queue. When called while other
+ * threads are pushing or popping it may already be out of date once it
+ * returns, but it is never more than the capacity.
+ */
+inline size_t darr_ring_size(const struct darr_ring *r)
+{
+	// The head is read first so that it is never past the tail, but both
+	// may have moved by more than the capacity in between.
+	size_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+	size_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+	size_t size = tail - head;
+
+	return size > r->mask + 1 ? r->mask + 1 : size;
+}
+
+/*
+ * Copies up to count elements to the back of the queue and returns how many
+ * were copied, which is fewer than count if the queue fills up. Only one
+ * thread may push at a time.
+ */
+size_t darr_ring_push(struct darr_ring *r, const void *elements, size_t count);
+
+/*
+ * Moves up to count elements from the front of the queue to out and returns
+ * how many were moved, which is fewer than count if the queue runs out. Only
+ * one thread may pop at a time.
+ */
+size_t darr_ring_pop(struct darr_ring *r, void *out, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_RING_H */
@@ -0,0 +1,580 @@
+#include "darr_seq.h"
+
+/*
+ * Nodes are at least half full so no tree of 64 bit sizes is taller than
+ * this.
+ */
+#define DARR_SEQ_MAX_HEIGHT 16
+
+extern inline void darr_seq_init(struct darr_seq *s, size_t element_size);
+
+extern inline size_t darr_seq_size(const struct darr_seq *s);
+
+extern inline int darr_seq_flatten(struct darr *d, struct darr_seq *s);
+
+/*
+ * A node of the tree. Leaves hold count elements and inner nodes hold count
+ * children along with the number of elements under each of them.
+ *
+ * Leaves are allocated with room for leaf_capacity elements, which may be
+ * less than the size of the struct.
+ */
+struct darr_seq_node {
+	size_t count;
+	union {
+		struct {
+			size_t sizes[DARR_SEQ_ORDER];
+			struct darr_seq_node *children[DARR_SEQ_ORDER];
+		} inner;
+		max_align_t align;
+	} u;
+};
+
+/*
+ * The nodes on the way from the root to a leaf. nodes[h] is the node at
+ * height h and slots[h] the index of the child that was followed in it.
+ */
+struct darr_seq_path {
+	struct darr_seq_node *nodes[DARR_SEQ_MAX_HEIGHT + 1];
+	size_t slots[DARR_SEQ_MAX_HEIGHT + 1];
+	size_t offset;
+};
+
+static char *darr_seq_elements(struct darr_seq_node *n)
+{
+	return (char *) &n->u;
+}
+
+static struct darr_seq_node *darr_seq_node_new(
+	const struct darr_seq *s,
+	unsigned height)
+{
+	size_t bytes = height > 0
+		? sizeof(struct darr_seq_node)
+		: offsetof(struct darr_seq_node, u)
+			+ s->leaf_capacity * s->element_size;
+	struct darr_seq_node *n = darr_mem_realloc(NULL, bytes);
+
+	if (n != NULL) {
+		n->count = 0;
+	}
+
+	return n;
+}
+
+static void darr_seq_node_free(struct darr_seq_node *n, unsigned height)
+{
+	if (height > 0) {
+		for (size_t c = 0; c < n->count; ++c) {
+			darr_seq_node_free(n->u.inner.children[c], height - 1);
+		}
+	}
+
+	darr_mem_free(n);
+}
+
+void darr_seq_deinit(struct darr_seq *s)
+{
+	if (s->root != NULL) {
+		darr_seq_node_free(s->root, s->height);
+	}
+
+	s->root = NULL;
+	s->size = 0;
+	s->height = 0;
+}
+
+/*
+ * Returns the number of elements under an inner node.
+ */
+static size_t darr_seq_inner_size(const struct darr_seq_node *n)
+{
+	size_t size = 0;
+
+	for (size_t c = 0; c < n->count; ++c) {
+		size += n->u.inner.sizes[c];
+	}
+
+	return size;
+}
+
+/*
+ * Copies count children and their sizes from one inner node to another, or
+ * within the same node.
+ */
+static void darr_seq_inner_move(
+	struct darr_seq_node *dst,
+	size_t di,
+	struct darr_seq_node *src,
+	size_t si,
+	size_t count)
+{
+	memmove(
+		dst->u.inner.sizes + di,
+		src->u.inner.sizes + si,
+		count * sizeof(size_t));
+	memmove(
+		dst->u.inner.children + di,
+		src->u.inner.children + si,
+		count * sizeof(struct darr_seq_node *));
+}
+
+/*
+ * Returns the leaf that holds the element at index i and replaces i with
+ * the index of the element in the leaf.
+ */
+static struct darr_seq_node *darr_seq_leaf(
+	const struct darr_seq *s,
+	size_t *i)
+{
+	struct darr_seq_node *n = s->root;
+
+	for (unsigned h = s->height; h > 0; --h) {
+		size_t c = 0;
+
+		while (*i >= n->u.inner.sizes[c]) {
+			*i -= n->u.inner.sizes[c];
+			c += 1;
+		}
+
+		n = n->u.inner.children[c];
+	}
+
+	return n;
+}
+
+/*
+ * Records the path to the leaf where index i is. When inserting, an index
+ * just past the end of a child belongs to that child, so that elements can
+ * be added at the end of the sequence.
+ */
+static void darr_seq_find(
+	const struct darr_seq *s,
+	size_t i,
+	int inserting,
+	struct darr_seq_path *p)
+{
+	struct darr_seq_node *n = s->root;
+
+	for (unsigned h = s->height; h > 0; --h) {
+		size_t c = 0;
+
+		while (c + 1 < n->count
+			&& (inserting
+				? i > n->u.inner.sizes[c]
+				: i >= n->u.inner.sizes[c])) {
+			i -= n->u.inner.sizes[c];
+			c += 1;
+		}
+
+		p->nodes[h] = n;
+		p->slots[h] = c;
+		n = n->u.inner.children[c];
+	}
+
+	p->nodes[0] = n;
+	p->offset = i;
+}
+
+void *darr_seq_element(struct darr_seq *s, size_t i)
+{
+	struct darr_seq_node *leaf = darr_seq_leaf(s, &i);
+	return darr_seq_elements(leaf) + i * s->element_size;
+}
+
+void *darr_seq_block(struct darr_seq *s, size_t i, size_t *count)
+{
+	struct darr_seq_node *leaf = darr_seq_leaf(s, &i);
+	*count = leaf->count - i;
+	return darr_seq_elements(leaf) + i * s->element_size;
+}
+
+/*
+ * Inserts k elements at index i of a full leaf and moves the second half of
+ * the result to the empty leaf r.
+ */
+static void darr_seq_leaf_split(
+	const struct darr_seq *s,
+	struct darr_seq_node *leaf,
+	struct darr_seq_node *r,
+	size_t i,
+	const char *src,
+	size_t k)
+{
+	size_t es = s->element_size;
+	size_t count = leaf->count;
+	size_t total = count + k;
+	size_t left = (total + 1) / 2;
+	char *p = darr_seq_elements(leaf);
+	char *q = darr_seq_elements(r);
+
+	// The result is p[0, i) followed by src[0, k) and p[i, count). Copy
+	// the part of each of them that goes to r, from the left end of r.
+	size_t out = 0;
+
+	if (i > left) {
+		memcpy(q, p + left * es, (i - left) * es);
+		out = i - left;
+	}
+
+	size_t from = left > i ? left - i : 0;
+
+	if (from < k) {
+		memcpy(q + out * es, src + from * es, (k - from) * es);
+		out += k - from;
+	}
+
+	from = left > i + k ? left - k : i;
+	memcpy(q + out * es, p + from * es, (count - from) * es);
+
+	// What stays in the leaf is p[0, i) followed by as much of src and
+	// p[i, count) as fits.
+	if (left > i) {
+		size_t taken = left - i < k ? left - i : k;
+
+		if (left > i + k) {
+			memmove(p + (i + k) * es, p + i * es, (left - i - k) * es);
+		}
+
+		memcpy(p + i * es, src, taken * es);
+	}
+
+	leaf->count = left;
+	r->count = total - left;
+}
+
+/*
+ * Inserts a child at index i of a full inner node and moves the second half
+ * of the result to the empty inner node r.
+ */
+static void darr_seq_inner_split(
+	struct darr_seq_node *n,
+	struct darr_seq_node *r,
+	size_t i,
+	struct darr_seq_node *child,
+	size_t size)
+{
+	size_t total = DARR_SEQ_ORDER + 1;
+	size_t left = total / 2;
+
+	if (i < left) {
+		darr_seq_inner_move(r, 0, n, left - 1, DARR_SEQ_ORDER - left + 1);
+		darr_seq_inner_move(n, i + 1, n, i, left - 1 - i);
+		n->u.inner.sizes[i] = size;
+		n->u.inner.children[i] = child;
+	} else {
+		size_t before = i - left;
+		darr_seq_inner_move(r, 0, n, left, before);
+		r->u.inner.sizes[before] = size;
+		r->u.inner.children[before] = child;
+		darr_seq_inner_move(r, before + 1, n, i, DARR_SEQ_ORDER - i);
+	}
+
+	n->count = left;
+	r->count = total - left;
+}
+
+/*
+ * Inserts at most half a leaf worth of elements, so that at most one leaf
+ * splits.
+ */
+static int darr_seq_insert_chunk(
+	struct darr_seq *s,
+	size_t i,
+	const char *src,
+	size_t k)
+{
+	if (s->root == NULL) {
+		s->root = darr_seq_node_new(s, 0);
+
+		if (s->root == NULL) {
+			return 0;
+		}
+	}
+
+	struct darr_seq_path p;
+	darr_seq_find(s, i, 1, &p);
+
+	// The nodes that split are all allocated before anything changes so
+	// that running out of memory leaves the tree as it was. Splits go up
+	// from the leaf for as long as the parent is full, and a root that
+	// splits needs a new root above it.
+	struct darr_seq_node *spare[DARR_SEQ_MAX_HEIGHT + 2];
+	size_t spares = 0;
+
+	if (p.nodes[0]->count + k > s->leaf_capacity) {
+		spares = 1;
+
+		while (spares <= s->height
+			&& p.nodes[spares]->count == DARR_SEQ_ORDER) {
+			spares += 1;
+		}
+
+		if (spares == s->height + 1) {
+			spares += 1;
+		}
+	}
+
+	for (size_t n = 0; n < spares; ++n) {
+		spare[n] = darr_seq_node_new(s, n);
+
+		if (spare[n] == NULL) {
+			while (n > 0) {
+				darr_mem_free(spare[--n]);
+			}
+
+			return 0;
+		}
+	}
+
+	struct darr_seq_node *leaf = p.nodes[0];
+	struct darr_seq_node *carry = NULL;
+	size_t carry_size = 0;
+	size_t es = s->element_size;
+
+	if (spares > 0) {
+		carry = spare[0];
+		darr_seq_leaf_split(s, leaf, carry, p.offset, src, k);
+		carry_size = carry->count;
+	} else {
+		char *e = darr_seq_elements(leaf);
+		memmove(
+			e + (p.offset + k) * es,
+			e + p.offset * es,
+			(leaf->count - p.offset) * es);
+		memcpy(e + p.offset * es, src, k * es);
+		leaf->count += k;
+	}
+
+	for (unsigned h = 1; h <= s->height; ++h) {
+		struct darr_seq_node *n = p.nodes[h];
+		size_t c = p.slots[h];
+
+		n->u.inner.sizes[c] += k - carry_size;
+
+		if (carry == NULL) {
+			continue;
+		}
+
+		if (n->count < DARR_SEQ_ORDER) {
+			darr_seq_inner_move(n, c + 2, n, c + 1, n->count - c - 1);
+			n->u.inner.sizes[c + 1] = carry_size;
+			n->u.inner.children[c + 1] = carry;
+			n->count += 1;
+			carry = NULL;
+			carry_size = 0;
+		} else {
+			struct darr_seq_node *r = spare[h];
+			darr_seq_inner_split(n, r, c + 1, carry, carry_size);
+			carry = r;
+			carry_size = darr_seq_inner_size(r);
+		}
+	}
+
+	if (carry != NULL) {
+		struct darr_seq_node *root = spare[s->height + 1];
+		root->count = 2;
+		root->u.inner.sizes[0] = s->size + k - carry_size;
+		root->u.inner.children[0] = s->root;
+		root->u.inner.sizes[1] = carry_size;
+		root->u.inner.children[1] = carry;
+		s->root = root;
+		s->height += 1;
+	}
+
+	s->size += k;
+	return 1;
+}
+
+int darr_seq_insert_view(struct darr_seq *s, size_t i, struct darr_view v)
+{
+	const char *src = darr_view_data(v);
+	size_t size = darr_view_size(v);
+	size_t chunk = s->leaf_capacity / 2;
+	size_t done = 0;
+
+	while (done < size) {
+		size_t k = size - done < chunk ? size - done : chunk;
+		const char *next = src + done * s->element_size;
+
+		if (!darr_seq_insert_chunk(s, i + done, next, k)) {
+			// Removing elements never fails.
+			darr_seq_remove(s, i, done);
+			return 0;
+		}
+
+		done += k;
+	}
+
+	return 1;
+}
+
+/*
+ * Evens out the children l and l + 1 of an inner node at height h + 1, one
+ * of which has fewer elements or children than it is allowed to. Merges
+ * them if they fit in one node.
+ *
+ * Returns 1 if they were merged, which removes a child from the parent.
+ */
+static int darr_seq_join(
+	struct darr_seq *s,
+	struct darr_seq_node *parent,
+	size_t l,
+	unsigned h)
+{
+	struct darr_seq_node *a = parent->u.inner.children[l];
+	struct darr_seq_node *b = parent->u.inner.children[l + 1];
+	size_t es = s->element_size;
+	size_t total = a->count + b->count;
+	size_t capacity = h == 0 ? s->leaf_capacity : DARR_SEQ_ORDER;
+
+	if (total <= capacity) {
+		if (h == 0) {
+			memcpy(
+				darr_seq_elements(a) + a->count * es,
+				darr_seq_elements(b),
+				b->count * es);
+		} else {
+			darr_seq_inner_move(a, a->count, b, 0, b->count);
+		}
+
+		a->count = total;
+		parent->u.inner.sizes[l] += parent->u.inner.sizes[l + 1];
+		darr_seq_inner_move(
+			parent,
+			l + 1,
+			parent,
+			l + 2,
+			parent->count - l - 2);
+		parent->count -= 1;
+		darr_mem_free(b);
+		return 1;
+	}
+
+	size_t target = total / 2;
+
+	if (a->count < target) {
+		size_t m = target - a->count;
+
+		if (h == 0) {
+			char *pa = darr_seq_elements(a);
+			char *pb = darr_seq_elements(b);
+			memcpy(pa + a->count * es, pb, m * es);
+			memmove(pb, pb + m * es, (b->count - m) * es);
+		} else {
+			darr_seq_inner_move(a, a->count, b, 0, m);
+			darr_seq_inner_move(b, 0, b, m, b->count - m);
+		}
+	} else {
+		size_t m = a->count - target;
+
+		if (h == 0) {
+			char *pa = darr_seq_elements(a);
+			char *pb = darr_seq_elements(b);
+			memmove(pb + m * es, pb, b->count * es);
+			memcpy(pb, pa + target * es, m * es);
+		} else {
+			darr_seq_inner_move(b, m, b, 0, b->count);
+			darr_seq_inner_move(b, 0, a, target, m);
+		}
+	}
+
+	a->count = target;
+	b->count = total - target;
+
+	size_t pair = parent->u.inner.sizes[l] + parent->u.inner.sizes[l + 1];
+	parent->u.inner.sizes[l] = h == 0 ? a->count : darr_seq_inner_size(a);
+	parent->u.inner.sizes[l + 1] = pair - parent->u.inner.sizes[l];
+	return 0;
+}
+
+/*
+ * Restores the minimum number of elements or children of the nodes on a
+ * path after elements were removed from its leaf.
+ */
+static void darr_seq_rebalance(struct darr_seq *s, struct darr_seq_path *p)
+{
+	for (unsigned h = 0; h < s->height; ++h) {
+		size_t min = h == 0 ? s->leaf_capacity / 2 : DARR_SEQ_ORDER / 2;
+
+		if (p->nodes[h]->count >= min) {
+			break;
+		}
+
+		// Inner nodes other than the root have at least 2 children so
+		// there is always a sibling.
+		struct darr_seq_node *parent = p->nodes[h + 1];
+		size_t c = p->slots[h + 1];
+		size_t l = c + 1 < parent->count ? c : c - 1;
+
+		if (!darr_seq_join(s, parent, l, h)) {
+			break;
+		}
+	}
+
+	while (s->height > 0 && s->root->count == 1) {
+		struct darr_seq_node *root = s->root;
+		s->root = root->u.inner.children[0];
+		s->height -= 1;
+		darr_mem_free(root);
+	}
+
+	if (s->height == 0 && s->root->count == 0) {
+		darr_mem_free(s->root);
+		s->root = NULL;
+	}
+}
+
+void darr_seq_remove(struct darr_seq *s, size_t start, size_t size)
+{
+	size_t es = s->element_size;
+
+	while (size > 0) {
+		struct darr_seq_path p;
+		darr_seq_find(s, start, 0, &p);
+
+		struct darr_seq_node *leaf = p.nodes[0];
+		size_t o = p.offset;
+		size_t n = leaf->count - o < size ? leaf->count - o : size;
+		char *e = darr_seq_elements(leaf);
+
+		memmove(
+			e + o * es,
+			e + (o + n) * es,
+			(leaf->count - o - n) * es);
+		leaf->count -= n;
+
+		for (unsigned h = 1; h <= s->height; ++h) {
+			p.nodes[h]->u.inner.sizes[p.slots[h]] -= n;
+		}
+
+		s->size -= n;
+		size -= n;
+
+		darr_seq_rebalance(s, &p);
+	}
+}
+
+int darr_seq_slice(
+	struct darr *d,
+	struct darr_seq *s,
+	size_t start,
+	size_t size)
+{
+	if (!darr_resize(d, size)) {
+		return 0;
+	}
+
+	size_t done = 0;
+
+	while (done < size) {
+		size_t count;
+		const void *block = darr_seq_block(s, start + done, &count);
+		count = size - done < count ? size - done : count;
+
+		memcpy(darr_element(d, done), block, count * s->element_size);
+		done += count;
+	}
+
+	return 1;
+}
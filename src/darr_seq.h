@@ -0,0 +1,137 @@
+#ifndef DARR_DARR_SEQ_H
+#define DARR_DARR_SEQ_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The number of bytes of elements a leaf can hold, and the number of
+ * children of inner nodes.
+ */
+#define DARR_SEQ_LEAF_BYTES 4096
+#define DARR_SEQ_ORDER 32
+
+struct darr_seq_node;
+
+/*
+ * A sequence of elements kept in a B+ tree for arrays that are too large to
+ * insert and remove elements in the middle of by moving the rest of them.
+ *
+ * Elements are stored in leaves of DARR_SEQ_LEAF_BYTES bytes. Inner nodes
+ * have up to 32 children and know how many elements are under each of them,
+ * so finding an element by index visits one node per level. Every node other
+ * than the root is at least half full.
+ *
+ * Inserting or removing elements only moves elements within the leaves
+ * involved and splits or joins nodes on the path up to the root, so it takes
+ * time proportional to the number of elements inserted or removed plus the
+ * height of the tree, no matter how many elements come after them.
+ *
+ * You can initialize it by calling darr_seq_init.
+ */
+struct darr_seq {
+	size_t element_size;
+	size_t leaf_capacity;
+	size_t size;
+	unsigned height;
+	struct darr_seq_node *root;
+};
+
+/*
+ * Initializes an empty sequence.
+ *
+ * Call darr_seq_deinit to deinitialize.
+ */
+inline void darr_seq_init(struct darr_seq *s, size_t element_size)
+{
+	size_t capacity = DARR_SEQ_LEAF_BYTES / element_size;
+
+	s->element_size = element_size;
+	s->leaf_capacity = capacity < 4 ? 4 : capacity;
+	s->size = 0;
+	s->height = 0;
+	s->root = NULL;
+}
+
+/*
+ * Deinitializes a sequence.
+ */
+void darr_seq_deinit(struct darr_seq *s);
+
+/*
+ * Returns the number of elements.
+ */
+inline size_t darr_seq_size(const struct darr_seq *s)
+{
+	return s->size;
+}
+
+/*
+ * Returns a pointer to the element at the given index. It remains valid
+ * until elements are inserted or removed.
+ */
+void *darr_seq_element(struct darr_seq *s, size_t i);
+
+/*
+ * Returns a pointer to the element at the given index and stores in count
+ * how many elements follow it in the same leaf, itself included. These are
+ * contiguous in memory, so a loop that adds count to the index every time
+ * visits every element a leaf at a time.
+ */
+void *darr_seq_block(struct darr_seq *s, size_t i, size_t *count);
+
+/*
+ * Inserts copies of the elements of the view before the element at the
+ * given index. An index equal to the size of the sequence adds them at the
+ * end. The view must not point into the sequence.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the sequence remains untouched.
+ */
+int darr_seq_insert_view(struct darr_seq *s, size_t i, struct darr_view v);
+
+/*
+ * Removes a range of elements.
+ *
+ * The start parameter must be an index into the sequence and the size
+ * parameter must not exceed the number of elements from there on.
+ */
+void darr_seq_remove(struct darr_seq *s, size_t start, size_t size);
+
+/*
+ * Replaces the elements of the array with copies of a range of elements of
+ * the sequence. The element size of the array must be the same as that of
+ * the sequence.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array remains untouched.
+ */
+int darr_seq_slice(
+	struct darr *d,
+	struct darr_seq *s,
+	size_t start,
+	size_t size);
+
+/*
+ * Replaces the elements of the array with copies of all elements of the
+ * sequence.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the array remains untouched.
+ */
+inline int darr_seq_flatten(struct darr *d, struct darr_seq *s)
+{
+	return darr_seq_slice(d, s, 0, darr_seq_size(s));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_SEQ_H */
@@ -0,0 +1,662 @@
+#include "darr_set.h"
+#include "darr_cpu.h"
+
+#ifdef DARR_CPU_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * Galloping is used when one array has more than this many times the
+ * elements of the other.
+ */
+#define DARR_SET_GALLOP_RATIO 32
+
+/*
+ * The kernels below are written for any element size and comparison
+ * function. They are forced inline and called with a constant size and a
+ * NULL comparison function for integer arrays so that comparisons compile
+ * to a single instruction.
+ */
+#define DARR_SET_KERNEL static inline __attribute__((always_inline))
+
+#define DARR_SET_COMPARE_AS(type, a, b) \
+	do { \
+		type x; \
+		type y; \
+		memcpy(&x, a, sizeof(type)); \
+		memcpy(&y, b, sizeof(type)); \
+		return (x > y) - (x < y); \
+	} while (0)
+
+DARR_SET_KERNEL int darr_set_compare(
+	darr_set_compare_t compare,
+	size_t size,
+	const void *a,
+	const void *b)
+{
+	if (compare != NULL) {
+		return compare(a, b);
+	}
+
+	// Other sizes are rejected by darr_set_comparable before any
+	// comparison is made.
+	switch (size) {
+	case 1:
+		DARR_SET_COMPARE_AS(uint8_t, a, b);
+	case 2:
+		DARR_SET_COMPARE_AS(uint16_t, a, b);
+	case 4:
+		DARR_SET_COMPARE_AS(uint32_t, a, b);
+	case 8:
+		DARR_SET_COMPARE_AS(uint64_t, a, b);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Returns whether elements of the given size can be compared, which without
+ * a comparison function takes a size that is compared by value.
+ */
+static int darr_set_comparable(darr_set_compare_t compare, size_t size)
+{
+	return compare != NULL
+		|| size == 1
+		|| size == 2
+		|| size == 4
+		|| size == 8;
+}
+
+/*
+ * Calls a kernel with constant arguments for integer arrays of 4 and 8
+ * bytes.
+ */
+#define DARR_SET_DISPATCH(result, kernel, size, compare, ...) \
+	do { \
+		if (compare == NULL && size == 4) { \
+			result = kernel(__VA_ARGS__, 4, NULL); \
+		} else if (compare == NULL && size == 8) { \
+			result = kernel(__VA_ARGS__, 8, NULL); \
+		} else { \
+			result = kernel(__VA_ARGS__, size, compare); \
+		} \
+	} while (0)
+
+/*
+ * Returns the index of the first element at or after start that does not
+ * come before the key. Probes 1, 2, 4, ... elements ahead and then does a
+ * binary search in the last interval.
+ */
+DARR_SET_KERNEL size_t darr_set_gallop(
+	const char *base,
+	size_t count,
+	size_t start,
+	const void *key,
+	size_t size,
+	darr_set_compare_t compare)
+{
+	size_t lo = start;
+	size_t step = 1;
+
+	while (lo + step < count
+		&& darr_set_compare(
+			compare,
+			size,
+			base + (lo + step) * size,
+			key) < 0) {
+		lo += step;
+		step *= 2;
+	}
+
+	// The element at lo comes before the key, unless lo is still start.
+	size_t hi = lo + step < count ? lo + step : count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const char *element = base + mid * size;
+
+		if (darr_set_compare(compare, size, element, key) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+int darr_unique(struct darr *d, darr_set_compare_t compare)
+{
+	size_t count = darr_size(d);
+
+	if (!darr_set_comparable(compare, d->element_size)) {
+		return 0;
+	}
+
+	if (count < 2) {
+		return 1;
+	}
+
+	size_t size = d->element_size;
+	char *p = d->data;
+	size_t kept = 1;
+
+	for (size_t i = 1; i < count; ++i) {
+		const char *last = p + (kept - 1) * size;
+
+		if (darr_set_compare(compare, size, last, p + i * size) != 0) {
+			if (kept != i) {
+				memcpy(p + kept * size, p + i * size, size);
+			}
+
+			kept += 1;
+		}
+	}
+
+	return darr_resize(d, kept);
+}
+
+/*
+ * Shrinks the output of a set operation to the size of its result.
+ */
+static void darr_set_finish(struct darr *out, size_t count)
+{
+	darr_truncate(out, count);
+}
+
+DARR_SET_KERNEL size_t darr_set_union_kernel(
+	char *out,
+	const char *a,
+	size_t na,
+	const char *b,
+	size_t nb,
+	size_t size,
+	darr_set_compare_t compare)
+{
+	size_t i = 0;
+	size_t j = 0;
+	size_t k = 0;
+
+	while (i < na && j < nb) {
+		int order = darr_set_compare(
+			compare,
+			size,
+			a + i * size,
+			b + j * size);
+
+		if (order <= 0) {
+			memcpy(out + k * size, a + i * size, size);
+			i += 1;
+			j += order == 0;
+		} else {
+			memcpy(out + k * size, b + j * size, size);
+			j += 1;
+		}
+
+		k += 1;
+	}
+
+	// Either array may be empty and have no data to copy from.
+	if (na > i) {
+		memcpy(out + k * size, a + i * size, (na - i) * size);
+		k += na - i;
+	}
+
+	if (nb > j) {
+		memcpy(out + k * size, b + j * size, (nb - j) * size);
+		k += nb - j;
+	}
+
+	return k;
+}
+
+int darr_set_union(
+	struct darr *out,
+	const struct darr *a,
+	const struct darr *b,
+	darr_set_compare_t compare)
+{
+	size_t na = darr_size(a);
+	size_t nb = darr_size(b);
+	size_t size = a->element_size;
+
+	if (!darr_set_comparable(compare, size)
+		|| !darr_resize(out, na + nb)) {
+		return 0;
+	}
+
+	if (na + nb == 0) {
+		return 1;
+	}
+
+	size_t k;
+	DARR_SET_DISPATCH(
+		k,
+		darr_set_union_kernel,
+		size,
+		compare,
+		out->data,
+		a->data,
+		na,
+		b->data,
+		nb);
+
+	darr_set_finish(out, k);
+	return 1;
+}
+
+/*
+ * The intersections of integer arrays below compute the first part of the
+ * result a block at a time and leave the rest to the scalar loop. Each takes
+ * the output, both arrays with their sizes and the indexes where it starts,
+ * which it advances. Returns the number of elements written.
+ */
+typedef size_t (*darr_set_intersect_t)(
+	void *out,
+	const void *a,
+	size_t na,
+	size_t *i,
+	const void *b,
+	size_t nb,
+	size_t *j);
+
+#ifdef DARR_CPU_X86
+static const uint8_t darr_set_shuffle_32[16][16] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 4, 5, 6, 7, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 8, 9, 10, 11, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 8, 9, 10, 11, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 4, 5, 6, 7, 8, 9, 10, 11, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0, 0, 0, 0 },
+	{ 12, 13, 14, 15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 12, 13, 14, 15, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 4, 5, 6, 7, 12, 13, 14, 15, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, 0, 0, 0, 0 },
+	{ 8, 9, 10, 11, 12, 13, 14, 15, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, 0, 0, 0, 0 },
+	{ 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+};
+
+/*
+ * Intersects 4 elements of each array at a time for as long as both have 4
+ * left and out has room for 4 more. Returns the number of elements written
+ * and advances i and j.
+ *
+ * Every element of the block of a is compared to every element of the block
+ * of b by comparing against the 4 rotations of b. The matches are then
+ * packed together with a shuffle. Whichever block ends with the smaller
+ * element is consumed.
+ */
+DARR_CPU_TARGET("ssse3")
+static size_t darr_set_intersect_32_ssse3(
+	void *out_data,
+	const void *a_data,
+	size_t na,
+	size_t *i,
+	const void *b_data,
+	size_t nb,
+	size_t *j)
+{
+	uint32_t *out = out_data;
+	const uint32_t *a = a_data;
+	const uint32_t *b = b_data;
+	size_t limit = na < nb ? na : nb;
+	size_t k = 0;
+
+	while (*i + 4 <= na && *j + 4 <= nb && k + 4 <= limit) {
+		__m128i va = _mm_loadu_si128((const __m128i *) (a + *i));
+		__m128i vb = _mm_loadu_si128((const __m128i *) (b + *j));
+		__m128i vb1 = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+		__m128i vb2 = _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2));
+		__m128i vb3 = _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3));
+		__m128i eq = _mm_or_si128(
+			_mm_or_si128(
+				_mm_cmpeq_epi32(va, vb),
+				_mm_cmpeq_epi32(va, vb1)),
+			_mm_or_si128(
+				_mm_cmpeq_epi32(va, vb2),
+				_mm_cmpeq_epi32(va, vb3)));
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		__m128i shuffle = _mm_loadu_si128(
+			(const __m128i *) darr_set_shuffle_32[mask]);
+
+		// Always writes 4 elements. out has room for limit of them.
+		_mm_storeu_si128(
+			(__m128i *) (out + k),
+			_mm_shuffle_epi8(va, shuffle));
+		k += __builtin_popcount(mask);
+
+		uint32_t amax = a[*i + 3];
+		uint32_t bmax = b[*j + 3];
+		*i += amax <= bmax ? 4 : 0;
+		*j += bmax <= amax ? 4 : 0;
+	}
+
+	return k;
+}
+
+static const uint32_t darr_set_permute_64[16][8] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 0, 0, 0, 0, 0, 0 },
+	{ 2, 3, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 0, 0, 0, 0 },
+	{ 4, 5, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 4, 5, 0, 0, 0, 0 },
+	{ 2, 3, 4, 5, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 4, 5, 0, 0 },
+	{ 6, 7, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 6, 7, 0, 0, 0, 0 },
+	{ 2, 3, 6, 7, 0, 0, 0, 0 },
+	{ 0, 1, 2, 3, 6, 7, 0, 0 },
+	{ 4, 5, 6, 7, 0, 0, 0, 0 },
+	{ 0, 1, 4, 5, 6, 7, 0, 0 },
+	{ 2, 3, 4, 5, 6, 7, 0, 0 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7 },
+};
+
+/*
+ * The same as darr_set_intersect_32_ssse3 for 8 byte elements.
+ */
+DARR_CPU_TARGET("avx2")
+static size_t darr_set_intersect_64_avx2(
+	void *out_data,
+	const void *a_data,
+	size_t na,
+	size_t *i,
+	const void *b_data,
+	size_t nb,
+	size_t *j)
+{
+	uint64_t *out = out_data;
+	const uint64_t *a = a_data;
+	const uint64_t *b = b_data;
+	size_t limit = na < nb ? na : nb;
+	size_t k = 0;
+
+	while (*i + 4 <= na && *j + 4 <= nb && k + 4 <= limit) {
+		__m256i va = _mm256_loadu_si256((const __m256i *) (a + *i));
+		__m256i vb = _mm256_loadu_si256((const __m256i *) (b + *j));
+		__m256i vb1 = _mm256_permute4x64_epi64(
+			vb,
+			_MM_SHUFFLE(0, 3, 2, 1));
+		__m256i vb2 = _mm256_permute4x64_epi64(
+			vb,
+			_MM_SHUFFLE(1, 0, 3, 2));
+		__m256i vb3 = _mm256_permute4x64_epi64(
+			vb,
+			_MM_SHUFFLE(2, 1, 0, 3));
+		__m256i eq = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_cmpeq_epi64(va, vb),
+				_mm256_cmpeq_epi64(va, vb1)),
+			_mm256_or_si256(
+				_mm256_cmpeq_epi64(va, vb2),
+				_mm256_cmpeq_epi64(va, vb3)));
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+		__m256i permute = _mm256_loadu_si256(
+			(const __m256i *) darr_set_permute_64[mask]);
+
+		_mm256_storeu_si256(
+			(__m256i *) (out + k),
+			_mm256_permutevar8x32_epi32(va, permute));
+		k += __builtin_popcount(mask);
+
+		uint64_t amax = a[*i + 3];
+		uint64_t bmax = b[*j + 3];
+		*i += amax <= bmax ? 4 : 0;
+		*j += bmax <= amax ? 4 : 0;
+	}
+
+	return k;
+}
+#endif
+
+/*
+ * The intersections of 4 and 8 byte integers for every level, NULL where
+ * there is no kernel for it.
+ */
+static const darr_set_intersect_t darr_set_intersect_32[DARR_CPU_LEVELS] = {
+#ifdef DARR_CPU_X86
+	[DARR_CPU_SSSE3] = darr_set_intersect_32_ssse3,
+	[DARR_CPU_AVX2] = darr_set_intersect_32_ssse3,
+#endif
+};
+
+static const darr_set_intersect_t darr_set_intersect_64[DARR_CPU_LEVELS] = {
+#ifdef DARR_CPU_X86
+	[DARR_CPU_AVX2] = darr_set_intersect_64_avx2,
+#endif
+};
+
+DARR_SET_KERNEL size_t darr_set_intersection_kernel(
+	char *out,
+	const char *a,
+	size_t na,
+	const char *b,
+	size_t nb,
+	size_t size,
+	darr_set_compare_t compare)
+{
+	size_t i = 0;
+	size_t j = 0;
+	size_t k = 0;
+
+	if (na > nb * DARR_SET_GALLOP_RATIO) {
+		for (; j < nb && i < na; ++j) {
+			const char *key = b + j * size;
+			i = darr_set_gallop(a, na, i, key, size, compare);
+
+			if (i < na
+				&& darr_set_compare(
+					compare,
+					size,
+					a + i * size,
+					key) == 0) {
+				memcpy(out + k * size, a + i * size, size);
+				k += 1;
+				i += 1;
+			}
+		}
+
+		return k;
+	}
+
+	if (nb > na * DARR_SET_GALLOP_RATIO) {
+		for (; i < na && j < nb; ++i) {
+			const char *key = a + i * size;
+			j = darr_set_gallop(b, nb, j, key, size, compare);
+
+			if (j < nb
+				&& darr_set_compare(
+					compare,
+					size,
+					b + j * size,
+					key) == 0) {
+				memcpy(out + k * size, key, size);
+				k += 1;
+				j += 1;
+			}
+		}
+
+		return k;
+	}
+
+	if (compare == NULL && (size == 4 || size == 8)) {
+		darr_set_intersect_t intersect = size == 4
+			? darr_set_intersect_32[darr_cpu_active]
+			: darr_set_intersect_64[darr_cpu_active];
+
+		if (intersect) {
+			k = intersect(out, a, na, &i, b, nb, &j);
+		}
+	}
+
+	while (i < na && j < nb) {
+		int order = darr_set_compare(
+			compare,
+			size,
+			a + i * size,
+			b + j * size);
+
+		if (order == 0) {
+			memcpy(out + k * size, a + i * size, size);
+			k += 1;
+		}
+
+		i += order <= 0;
+		j += order >= 0;
+	}
+
+	return k;
+}
+
+int darr_set_intersection(
+	struct darr *out,
+	const struct darr *a,
+	const struct darr *b,
+	darr_set_compare_t compare)
+{
+	size_t na = darr_size(a);
+	size_t nb = darr_size(b);
+	size_t size = a->element_size;
+
+	if (!darr_set_comparable(compare, size)
+		|| !darr_resize(out, na < nb ? na : nb)) {
+		return 0;
+	}
+
+	if (na == 0 || nb == 0) {
+		return 1;
+	}
+
+	size_t k;
+	DARR_SET_DISPATCH(
+		k,
+		darr_set_intersection_kernel,
+		size,
+		compare,
+		out->data,
+		a->data,
+		na,
+		b->data,
+		nb);
+
+	darr_set_finish(out, k);
+	return 1;
+}
+
+DARR_SET_KERNEL size_t darr_set_difference_kernel(
+	char *out,
+	const char *a,
+	size_t na,
+	const char *b,
+	size_t nb,
+	size_t size,
+	darr_set_compare_t compare)
+{
+	size_t i = 0;
+	size_t j = 0;
+	size_t k = 0;
+
+	if (na > nb * DARR_SET_GALLOP_RATIO) {
+		// Copies the runs of a between the elements of b in bulk.
+		for (; j < nb && i < na; ++j) {
+			const char *key = b + j * size;
+			size_t next = darr_set_gallop(
+				a,
+				na,
+				i,
+				key,
+				size,
+				compare);
+
+			memcpy(out + k * size, a + i * size, (next - i) * size);
+			k += next - i;
+			i = next;
+
+			if (i < na
+				&& darr_set_compare(
+					compare,
+					size,
+					a + i * size,
+					key) == 0) {
+				i += 1;
+			}
+		}
+	} else if (nb > na * DARR_SET_GALLOP_RATIO) {
+		for (; i < na && j < nb; ++i) {
+			const char *key = a + i * size;
+			j = darr_set_gallop(b, nb, j, key, size, compare);
+
+			if (j == nb
+				|| darr_set_compare(
+					compare,
+					size,
+					b + j * size,
+					key) != 0) {
+				memcpy(out + k * size, key, size);
+				k += 1;
+			}
+		}
+	} else {
+		while (i < na && j < nb) {
+			int order = darr_set_compare(
+				compare,
+				size,
+				a + i * size,
+				b + j * size);
+
+			if (order < 0) {
+				memcpy(out + k * size, a + i * size, size);
+				k += 1;
+			}
+
+			i += order <= 0;
+			j += order >= 0;
+		}
+	}
+
+	// b may hold all of a, in which case a may be empty and have no data.
+	if (na > i) {
+		memcpy(out + k * size, a + i * size, (na - i) * size);
+		k += na - i;
+	}
+
+	return k;
+}
+
+int darr_set_difference(
+	struct darr *out,
+	const struct darr *a,
+	const struct darr *b,
+	darr_set_compare_t compare)
+{
+	size_t na = darr_size(a);
+	size_t size = a->element_size;
+
+	if (!darr_set_comparable(compare, size) || !darr_resize(out, na)) {
+		return 0;
+	}
+
+	if (na == 0) {
+		return 1;
+	}
+
+	size_t k;
+	DARR_SET_DISPATCH(
+		k,
+		darr_set_difference_kernel,
+		size,
+		compare,
+		out->data,
+		a->data,
+		darr_size(a),
+		b->data,
+		darr_size(b));
+
+	darr_set_finish(out, k);
+	return 1;
+}
@@ -0,0 +1,88 @@
+#ifndef DARR_DARR_SET_H
+#define DARR_DARR_SET_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compares two elements. Must return a negative number if the first element
+ * comes before the second one, a positive number if it comes after and zero
+ * if they are equal. This is the same contract as the comparison function of
+ * qsort.
+ *
+ * The functions below accept NULL in its place for arrays of unsigned
+ * integers of 1, 2, 4 or 8 bytes, which are then compared by value. With
+ * NULL they fail for arrays of any other element size. This
+ * also enables the fastest code paths: intersections of 4 byte integers are
+ * computed 4 at a time with SSSE3 and of 8 byte integers 4 at a time with
+ * AVX2, when the CPU supports them (see darr_cpu.h).
+ */
+typedef int (*darr_set_compare_t)(const void *, const void *);
+
+/*
+ * Removes consecutive elements that are equal to the one before them, which
+ * in a sorted array leaves each element once. Elements are moved down in a
+ * single pass and the array is shrunk once at the end.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the remaining elements are at the start of the array but its
+ * size is unchanged. When it fails because the elements cannot be compared
+ * the array remains untouched.
+ */
+int darr_unique(struct darr *d, darr_set_compare_t compare);
+
+/*
+ * The set operations below take two sorted arrays without duplicates and
+ * replace the elements of out with the result, which is also sorted and
+ * without duplicates. All three arrays must have the same element size and
+ * out must not be a or b.
+ *
+ * out is resized once to the largest size the result can have and shrunk
+ * once to its actual size.
+ *
+ * When one array is much larger than the other, intersections and
+ * differences look up the elements of the smaller one in the larger one with
+ * a galloping search instead of walking over every element.
+ *
+ * Each returns 1 on success, 0 on failure.
+ *
+ * On failure out remains untouched.
+ */
+
+/*
+ * Elements that are in a, in b or in both. Elements that are in both are
+ * taken from a.
+ */
+int darr_set_union(
+	struct darr *out,
+	const struct darr *a,
+	const struct darr *b,
+	darr_set_compare_t compare);
+
+/*
+ * Elements that are in both a and b, taken from a.
+ */
+int darr_set_intersection(
+	struct darr *out,
+	const struct darr *a,
+	const struct darr *b,
+	darr_set_compare_t compare);
+
+/*
+ * Elements that are in a but not in b.
+ */
+int darr_set_difference(
+	struct darr *out,
+	const struct darr *a,
+	const struct darr *b,
+	darr_set_compare_t compare);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_SET_H */
@@ -0,0 +1,44 @@
+#include "darr_soa.h"
+
+extern inline struct darr *darr_soa_darr(struct darr_soa *s, size_t c);
+
+extern inline int darr_soa_init(
+	struct darr_soa *s,
+	size_t columns,
+	const size_t *element_sizes);
+
+extern inline void darr_soa_deinit(struct darr_soa *s);
+
+extern inline size_t darr_soa_size(const struct darr_soa *s);
+
+extern inline size_t darr_soa_columns(const struct darr_soa *s);
+
+extern inline void *darr_soa_column(struct darr_soa *s, size_t c);
+
+extern inline const void *darr_soa_column_const(
+	const struct darr_soa *s,
+	size_t c);
+
+extern inline struct darr_view darr_soa_column_view(
+	const struct darr_soa *s,
+	size_t c);
+
+extern inline void *darr_soa_element(struct darr_soa *s, size_t c, size_t i);
+
+extern inline const void *darr_soa_element_const(
+	const struct darr_soa *s,
+	size_t c,
+	size_t i);
+
+extern inline int darr_soa_resize(struct darr_soa *s, size_t size);
+
+extern inline int darr_soa_push(struct darr_soa *s, const void *const *values);
+
+extern inline int darr_soa_remove(
+	struct darr_soa *s,
+	size_t start,
+	size_t size);
+
+extern inline int darr_soa_swap_remove(struct darr_soa *s, size_t i);
+
+extern inline void darr_soa_swap(struct darr_soa *s, struct darr_soa *other);
@@ -0,0 +1,266 @@
+#ifndef DARR_DARR_SOA_H
+#define DARR_DARR_SOA_H
+
+#include "darr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A struct of arrays. Stores records by keeping each field in its own array,
+ * called a column. All columns have the same number of elements.
+ *
+ * Loops that only read a few fields of every record only pull those columns
+ * through the cache and can be vectorized by the compiler.
+ *
+ * You can initialize it by calling darr_soa_init.
+ */
+struct darr_soa {
+	size_t size;
+	struct darr columns;
+};
+
+/*
+ * This is an implementation detail. Don't call this function.
+ *
+ * Returns the array that stores a column.
+ */
+inline struct darr *darr_soa_darr(struct darr_soa *s, size_t c)
+{
+	return (struct darr *) darr_element(&s->columns, c);
+}
+
+/*
+ * Initializes a darr_soa struct with the given number of columns. The size of
+ * the elements of each column is read from the element_sizes array.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure, the struct is not initialized.
+ *
+ * Call darr_soa_deinit to deinitialize.
+ */
+inline int darr_soa_init(
+	struct darr_soa *s,
+	size_t columns,
+	const size_t *element_sizes)
+{
+	darr_init(&s->columns, sizeof(struct darr));
+
+	if (!darr_resize(&s->columns, columns)) {
+		return 0;
+	}
+
+	for (size_t c = 0; c < columns; ++c) {
+		darr_init(darr_soa_darr(s, c), element_sizes[c]);
+	}
+
+	s->size = 0;
+	return 1;
+}
+
+/*
+ * Deinitializes a darr_soa struct.
+ */
+inline void darr_soa_deinit(struct darr_soa *s)
+{
+	for (size_t c = 0; c < darr_size(&s->columns); ++c) {
+		darr_deinit(darr_soa_darr(s, c));
+	}
+
+	darr_deinit(&s->columns);
+}
+
+/*
+ * Returns the number of records.
+ */
+inline size_t darr_soa_size(const struct darr_soa *s)
+{
+	return s->size;
+}
+
+/*
+ * Returns the number of columns.
+ */
+inline size_t darr_soa_columns(const struct darr_soa *s)
+{
+	return darr_size(&s->columns);
+}
+
+/*
+ * Returns a pointer to the first element of a column.
+ *
+ * The pointer is valid until either one of these events occur:
+ * - size changes.
+ * - the struct is deinitialized.
+ */
+inline void *darr_soa_column(struct darr_soa *s, size_t c)
+{
+	return darr_data(darr_soa_darr(s, c));
+}
+
+/*
+ * Like darr_soa_column, but returns a const pointer.
+ */
+inline const void *darr_soa_column_const(const struct darr_soa *s, size_t c)
+{
+	return darr_soa_column((struct darr_soa *) s, c);
+}
+
+/*
+ * Returns a view of the elements of a column.
+ */
+inline struct darr_view darr_soa_column_view(
+	const struct darr_soa *s,
+	size_t c)
+{
+	return darr_view_slice(
+		darr_soa_darr((struct darr_soa *) s, c),
+		0,
+		s->size);
+}
+
+/*
+ * Returns a pointer to the field of a record stored in the given column.
+ *
+ * The restrictions for the pointers returned by darr_soa_column apply.
+ */
+inline void *darr_soa_element(struct darr_soa *s, size_t c, size_t i)
+{
+	return darr_element(darr_soa_darr(s, c), i);
+}
+
+/*
+ * Like darr_soa_element, but returns a const pointer.
+ */
+inline const void *darr_soa_element_const(
+	const struct darr_soa *s,
+	size_t c,
+	size_t i)
+{
+	return darr_soa_element((struct darr_soa *) s, c, i);
+}
+
+/*
+ * Changes the number of records of every column.
+ *
+ * Returns 1 on success, 0 on failure. Decreasing the number of records never
+ * fails.
+ *
+ * On failure the size and the contents of the columns remain untouched.
+ */
+inline int darr_soa_resize(struct darr_soa *s, size_t size)
+{
+	if (size <= s->size) {
+		for (size_t c = 0; c < darr_soa_columns(s); ++c) {
+			darr_truncate(darr_soa_darr(s, c), size);
+		}
+
+		s->size = size;
+		return 1;
+	}
+
+	for (size_t c = 0; c < darr_soa_columns(s); ++c) {
+		if (!darr_resize(darr_soa_darr(s, c), size)) {
+			// Growing keeps the old records, so truncating the
+			// columns that already grew restores them.
+			while (c-- > 0) {
+				darr_truncate(darr_soa_darr(s, c), s->size);
+			}
+
+			return 0;
+		}
+	}
+
+	s->size = size;
+	return 1;
+}
+
+/*
+ * Adds a record to the end.
+ *
+ * The values parameter must hold one pointer per column, each one pointing to
+ * the value of the field stored in that column.
+ *
+ * Returns 1 on success, 0 on failure.
+ *
+ * On failure the size and the contents of the columns remain untouched.
+ */
+inline int darr_soa_push(struct darr_soa *s, const void *const *values)
+{
+	size_t i = s->size;
+
+	if (!darr_soa_resize(s, i + 1)) {
+		return 0;
+	}
+
+	for (size_t c = 0; c < darr_soa_columns(s); ++c) {
+		struct darr *column = darr_soa_darr(s, c);
+		memcpy(darr_element(column, i), values[c], column->element_size);
+	}
+
+	return 1;
+}
+
+/*
+ * Removes a range of records, keeping the order of the remaining ones.
+ *
+ * Always returns 1. Removing records cannot fail.
+ */
+inline int darr_soa_remove(struct darr_soa *s, size_t start, size_t size)
+{
+	for (size_t c = 0; c < darr_soa_columns(s); ++c) {
+		struct darr *column = darr_soa_darr(s, c);
+		darr_shift_slice_left(column, size, start, s->size - start);
+	}
+
+	return darr_soa_resize(s, s->size - size);
+}
+
+/*
+ * Removes a record by moving the last record into its place.
+ *
+ * This does not preserve the order of the records but only moves one record.
+ *
+ * Always returns 1. Removing a record cannot fail.
+ *
+ * Behavior is undefined if i is not less than the number of records.
+ */
+inline int darr_soa_swap_remove(struct darr_soa *s, size_t i)
+{
+	size_t last = s->size - 1;
+
+	if (i != last) {
+		for (size_t c = 0; c < darr_soa_columns(s); ++c) {
+			struct darr *column = darr_soa_darr(s, c);
+
+			memcpy(
+				darr_element(column, i),
+				darr_element(column, last),
+				column->element_size);
+		}
+	}
+
+	return darr_soa_resize(s, last);
+}
+
+/*
+ * Swaps the records with another darr_soa struct.
+ *
+ * Both must have the same columns.
+ */
+inline void darr_soa_swap(struct darr_soa *s, struct darr_soa *other)
+{
+	struct darr_soa tmp;
+
+	tmp = *s;
+	*s = *other;
+	*other = tmp;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DARR_DARR_SOA_H */
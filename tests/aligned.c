@@ -0,0 +1,90 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+static int is_aligned(const void *p, size_t alignment)
+{
+	return (uintptr_t) p % alignment == 0;
+}
+
+int main(void)
+{
+	struct darr array;
+	darr_init_aligned(&array, sizeof(int), 64, 32);
+
+	for (int i = 0; i < 100; ++i) {
+		if (!darr_grow(&array, 1)) {
+			fprintf(stderr, "Failed to grow.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		if (!is_aligned(darr_data(&array), 64)) {
+			fprintf(stderr, "Elements are not aligned after growing.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		*(int *) darr_last(&array) = i;
+	}
+
+	darr_shrink(&array, 50);
+
+	if (!is_aligned(darr_data(&array), 64)) {
+		fprintf(stderr, "Elements are not aligned after shrinking.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	int *element = darr_data(&array);
+
+	for (int i = 0; i < 50; ++i) {
+		if (element[i] != i) {
+			fprintf(stderr, "Element %d was not preserved.\n", i);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	// The padding may be read and written.
+	memset(darr_end(&array), 0, 32);
+
+	struct darr copy;
+	darr_copy(&copy, &array);
+
+	struct darr slice;
+	darr_copy_slice(&slice, &array, 3, 5);
+
+	if (!is_aligned(darr_data(&copy), 64) || !is_aligned(darr_data(&slice), 64)) {
+		fprintf(stderr, "Copies are not aligned.\n");
+		darr_deinit(&array);
+		darr_deinit(&copy);
+		darr_deinit(&slice);
+		return 1;
+	}
+
+	if (*(int *) darr_first(&slice) != 3 || *(int *) darr_last(&copy) != 49) {
+		fprintf(stderr, "Copies do not have the expected elements.\n");
+		darr_deinit(&array);
+		darr_deinit(&copy);
+		darr_deinit(&slice);
+		return 1;
+	}
+
+	darr_resize(&array, 0);
+	darr_resize(&array, 10);
+
+	if (!is_aligned(darr_data(&array), 64)) {
+		fprintf(stderr, "Alignment was lost after emptying the array.\n");
+		darr_deinit(&array);
+		darr_deinit(&copy);
+		darr_deinit(&slice);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_deinit(&copy);
+	darr_deinit(&slice);
+	return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+
+#include "../src/darr_bits.h"
+
+int main(void)
+{
+	struct darr_bits bits;
+	darr_bits_init(&bits);
+
+	for (int i = 0; i < 300; ++i) {
+		darr_bits_push(&bits, i % 3 == 0);
+	}
+
+	if (darr_bits_size(&bits) != 300) {
+		fprintf(stderr, "Wrong number of bits.\n");
+		darr_bits_deinit(&bits);
+		return 1;
+	}
+
+	if (darr_bits_popcount(&bits) != 100) {
+		fprintf(stderr, "Wrong number of bits set.\n");
+		darr_bits_deinit(&bits);
+		return 1;
+	}
+
+	size_t expected = 0;
+
+	for (size_t i = darr_bits_next(&bits, 0);
+		i < darr_bits_size(&bits);
+		i = darr_bits_next(&bits, i + 1)) {
+		if (i != expected) {
+			fprintf(stderr, "Iterated over bit %zu instead of %zu.\n", i, expected);
+			darr_bits_deinit(&bits);
+			return 1;
+		}
+
+		expected += 3;
+	}
+
+	if (expected != 300) {
+		fprintf(stderr, "Did not iterate over every bit set.\n");
+		darr_bits_deinit(&bits);
+		return 1;
+	}
+
+	struct darr_bits other;
+	darr_bits_init(&other);
+	darr_bits_resize(&other, 300);
+	darr_bits_set_all(&other);
+	darr_bits_clear(&other, 0);
+	darr_bits_flip(&other, 3);
+
+	darr_bits_and(&bits, &other);
+
+	if (darr_bits_find_first(&bits) != 6 || darr_bits_popcount(&bits) != 98) {
+		fprintf(stderr, "Wrong result for and.\n");
+		darr_bits_deinit(&bits);
+		darr_bits_deinit(&other);
+		return 1;
+	}
+
+	darr_bits_or(&bits, &other);
+
+	if (darr_bits_popcount(&bits) != 298) {
+		fprintf(stderr, "Wrong result for or.\n");
+		darr_bits_deinit(&bits);
+		darr_bits_deinit(&other);
+		return 1;
+	}
+
+	darr_bits_andnot(&bits, &other);
+
+	if (darr_bits_popcount(&bits) != 0) {
+		fprintf(stderr, "Wrong result for andnot.\n");
+		darr_bits_deinit(&bits);
+		darr_bits_deinit(&other);
+		return 1;
+	}
+
+	darr_bits_xor(&bits, &other);
+	darr_bits_resize(&bits, 100);
+
+	if (darr_bits_popcount(&bits) != 98 || darr_bits_get(&bits, 3)) {
+		fprintf(stderr, "Wrong result for xor.\n");
+		darr_bits_deinit(&bits);
+		darr_bits_deinit(&other);
+		return 1;
+	}
+
+	darr_bits_resize(&bits, 200);
+
+	if (darr_bits_popcount(&bits) != 98) {
+		fprintf(stderr, "Bits added by resize are not zero.\n");
+		darr_bits_deinit(&bits);
+		darr_bits_deinit(&other);
+		return 1;
+	}
+
+	darr_bits_deinit(&bits);
+	darr_bits_deinit(&other);
+	return 0;
+}
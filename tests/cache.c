@@ -0,0 +1,63 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 100);
+
+	void *first = darr_data(&array);
+
+	darr_deinit(&array);
+
+	const struct darr_cache_stats *stats = darr_cache_stats_get();
+
+	if (stats->returns != 1) {
+		fprintf(stderr, "Buffer was not returned to the cache.\n");
+		return 1;
+	}
+
+	// 400 bytes went into the class of 256 bytes, so a request for up to 256
+	// bytes can be served by it.
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 64);
+
+	if (darr_data(&array) != first || stats->hits != 1) {
+		fprintf(stderr, "Buffer was not taken from the cache.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	// Growing an existing buffer uses realloc.
+	darr_resize(&array, 1000);
+	darr_resize(&array, 0);
+
+	struct darr array2;
+	darr_init(&array2, sizeof(int));
+	darr_resize(&array2, 2000);
+
+	if (stats->misses != 2) {
+		fprintf(stderr, "Larger request was not counted as a miss.\n");
+		darr_deinit(&array2);
+		return 1;
+	}
+
+	if (darr_cache_limit_set(DARR_CACHE_CLASSES, 16)) {
+		fprintf(stderr, "Set the limit of a missing size class.\n");
+		darr_deinit(&array2);
+		return 1;
+	}
+
+	darr_cache_limit_set(12, 0);
+	darr_deinit(&array2);
+
+	if (stats->overflows != 1) {
+		fprintf(stderr, "Size class limit was not respected.\n");
+		return 1;
+	}
+
+	darr_cache_flush();
+	return 0;
+}
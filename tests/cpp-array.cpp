@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+
+#include "../src/darr.hpp"
+
+static_assert(
+	sizeof(darr::array<int>) == sizeof(struct darr),
+	"The wrapper must have the same size as struct darr.");
+
+static_assert(
+	std::is_nothrow_move_constructible<darr::array<int> >::value,
+	"The wrapper must be nothrow move constructible.");
+
+int main()
+{
+	darr::array<int> array;
+
+	for (int i = 0; i < 8; ++i) {
+		array.push_back(7 - i);
+	}
+
+	std::sort(array.begin(), array.end());
+
+	for (int i = 0; i < 8; ++i) {
+		if (array[i] != i) {
+			fprintf(stderr, "Element %d was not sorted.\n", i);
+			return 1;
+		}
+	}
+
+	// C functions see the same elements.
+	if (*static_cast<int *>(darr_last(array.c_darr())) != 7) {
+		fprintf(stderr, "C function does not see the last element.\n");
+		return 1;
+	}
+
+	// Pushing an element of the array itself, every time into a buffer
+	// that has to grow.
+	darr::array<int> pushed;
+	pushed.push_back(1);
+
+	for (int i = 0; i < 10; ++i) {
+		if (!pushed.push_back(pushed[0])) {
+			fprintf(stderr, "Failed to push an element of the array.\n");
+			return 1;
+		}
+	}
+
+	if (pushed.size() != 11 || pushed.back() != 1) {
+		fprintf(stderr, "Pushed a wrong copy of an element.\n");
+		return 1;
+	}
+
+	darr::array<int> moved(std::move(array));
+
+	if (!array.empty() || moved.size() != 8) {
+		fprintf(stderr, "Move constructor did not transfer elements.\n");
+		return 1;
+	}
+
+	darr::array<int> copy;
+	copy.assign(moved.view(2, 3));
+
+	if (copy.size() != 3 || copy.front() != 2 || copy.back() != 4) {
+		fprintf(stderr, "Assigned copy does not have the expected elements.\n");
+		return 1;
+	}
+
+	// Assigning keeps the alignment and padding of the array.
+	struct darr raw;
+	darr_init_aligned(&raw, sizeof(int), 64, 32);
+	darr::array<int> aligned(std::move(raw));
+
+	if (!aligned.assign(moved)
+		|| aligned.size() != 8
+		|| aligned.c_darr()->alignment != 64
+		|| aligned.c_darr()->padding != 32
+		|| (uintptr_t) aligned.data() % 64 != 0) {
+		fprintf(stderr, "Assign lost the alignment of the array.\n");
+		return 1;
+	}
+
+	struct darr released = copy.release();
+
+	if (darr_size(&released) != 3 || !copy.empty()) {
+		fprintf(stderr, "Release did not hand over the elements.\n");
+		darr_deinit(&released);
+		return 1;
+	}
+
+	darr::array<int> adopted(std::move(released));
+
+	if (adopted.size() != 3 || darr_size(&released) != 0) {
+		fprintf(stderr, "Adopting a struct darr did not take ownership.\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,37 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+#include "../src/darr_cpu.h"
+
+int main(void)
+{
+	if (darr_cpu_level() != DARR_CPU_SCALAR) {
+		fprintf(stderr, "Started with level %s instead of SCALAR.\n",
+			darr_cpu_level_name(darr_cpu_level()));
+		return 1;
+	}
+
+	// The scalar kernels work like the others.
+	struct darr array;
+	darr_init(&array, sizeof(int));
+
+	int value = 42;
+
+	if (!darr_resize_fill(&array, 1000, &value)) {
+		fprintf(stderr, "Failed to fill.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	for (size_t i = 0; i < 1000; ++i) {
+		if (*(int *) darr_element(&array, i) != value) {
+			fprintf(stderr, "Element %zu was not filled.\n", i);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	darr_deinit(&array);
+
+	return 0;
+}
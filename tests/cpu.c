@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../src/darr_bits.h"
+#include "../src/darr_cpu.h"
+#include "../src/darr_packed.h"
+#include "../src/darr_set.h"
+
+static int check_fill(void)
+{
+	size_t sizes[] = { 2, 4, 8, 16 };
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); ++s) {
+		struct darr array;
+		darr_init(&array, sizes[s]);
+
+		unsigned char e[16];
+
+		for (size_t i = 0; i < sizes[s]; ++i) {
+			e[i] = (unsigned char) (i + 1);
+		}
+
+		if (!darr_resize(&array, 1000)) {
+			darr_deinit(&array);
+			return 0;
+		}
+
+		memset(darr_data(&array), 0, 1000 * sizes[s]);
+		darr_fill(&array, 3, 777, e);
+
+		for (size_t i = 0; i < 1000; ++i) {
+			const unsigned char *p = darr_element(&array, i);
+			int filled = i >= 3 && i < 3 + 777;
+
+			for (size_t k = 0; k < sizes[s]; ++k) {
+				if (p[k] != (filled ? e[k] : 0)) {
+					darr_deinit(&array);
+					return 0;
+				}
+			}
+		}
+
+		darr_deinit(&array);
+	}
+
+	return 1;
+}
+
+static int check_move(void)
+{
+	static unsigned char actual[1 << 16];
+	static unsigned char expected[1 << 16];
+
+	// Overlapping moves in both directions with unaligned ends.
+	size_t moves[][3] = {
+		{ 100, 37, 40000 },
+		{ 37, 100, 40000 },
+		{ 5, 9, 63 },
+	};
+
+	for (size_t m = 0; m < sizeof(moves) / sizeof(*moves); ++m) {
+		for (size_t i = 0; i < sizeof(actual); ++i) {
+			actual[i] = expected[i] = (unsigned char) (i * 31);
+		}
+
+		darr_data_move_stream(
+			actual + moves[m][0],
+			actual + moves[m][1],
+			moves[m][2]);
+		memmove(
+			expected + moves[m][0],
+			expected + moves[m][1],
+			moves[m][2]);
+
+		if (memcmp(actual, expected, sizeof(actual)) != 0) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Intersects the multiples of 2 with the multiples of 3, which leaves the
+ * multiples of 6, with integers of the given size.
+ */
+static int check_intersection(size_t size)
+{
+	struct darr a;
+	struct darr b;
+	struct darr out;
+	darr_init(&a, size);
+	darr_init(&b, size);
+	darr_init(&out, size);
+
+	int result = darr_resize(&a, 1000) && darr_resize(&b, 1000);
+
+	for (size_t i = 0; result && i < 1000; ++i) {
+		uint64_t x = i * 2;
+		uint64_t y = i * 3;
+
+		if (size == 4) {
+			*(uint32_t *) darr_element(&a, i) = (uint32_t) x;
+			*(uint32_t *) darr_element(&b, i) = (uint32_t) y;
+		} else {
+			*(uint64_t *) darr_element(&a, i) = x;
+			*(uint64_t *) darr_element(&b, i) = y;
+		}
+	}
+
+	result = result
+		&& darr_set_intersection(&out, &a, &b, NULL)
+		&& darr_size(&out) == 334;
+
+	for (size_t i = 0; result && i < darr_size(&out); ++i) {
+		uint64_t value = size == 4
+			? *(uint32_t *) darr_element(&out, i)
+			: *(uint64_t *) darr_element(&out, i);
+
+		result = value == i * 6;
+	}
+
+	darr_deinit(&a);
+	darr_deinit(&b);
+	darr_deinit(&out);
+
+	return result;
+}
+
+static int check_bits(void)
+{
+	struct darr_bits bits;
+	struct darr_bits other;
+	darr_bits_init(&bits);
+	darr_bits_init(&other);
+
+	// A long run of zero words before the first bit set.
+	int result = darr_bits_resize(&bits, 3000)
+		&& darr_bits_resize(&other, 3000);
+
+	for (size_t i = 2000; result && i < 3000; i += 7) {
+		darr_bits_set(&bits, i);
+	}
+
+	for (size_t i = 0; result && i < 3000; i += 2) {
+		darr_bits_set(&other, i);
+	}
+
+	result = result
+		&& darr_bits_popcount(&bits) == 143
+		&& darr_bits_next(&bits, 0) == 2000
+		&& darr_bits_next(&bits, 2995) == 3000;
+
+	if (result) {
+		// Every other multiple of 7 is even.
+		darr_bits_and(&bits, &other);
+		result = darr_bits_popcount(&bits) == 72
+			&& darr_bits_next(&bits, 2001) == 2014;
+	}
+
+	if (result) {
+		darr_bits_xor(&bits, &bits);
+		result = darr_bits_popcount(&bits) == 0
+			&& darr_bits_next(&bits, 0) == 3000;
+	}
+
+	darr_bits_deinit(&bits);
+	darr_bits_deinit(&other);
+
+	return result;
+}
+
+/*
+ * Packs two blocks whose widest difference takes the given number of bits,
+ * followed by a few unpacked values, and unpacks them again.
+ */
+static int check_packed_bits(unsigned bits)
+{
+	struct darr_packed packed;
+	struct darr expected;
+	struct darr decoded;
+	darr_packed_init(&packed);
+	darr_init(&expected, sizeof(uint64_t));
+	darr_init(&decoded, sizeof(uint64_t));
+
+	size_t count = 2 * DARR_PACKED_BLOCK + 5;
+	int result = darr_resize(&expected, count);
+	uint64_t value = 0;
+
+	for (size_t i = 0; result && i < count; ++i) {
+		if (bits > 0 && i == DARR_PACKED_BLOCK + 1) {
+			value += UINT64_C(1) << (bits - 1);
+		} else if (bits > 1) {
+			value += i % 3;
+		} else if (bits == 1) {
+			value += i % 2;
+		}
+
+		*(uint64_t *) darr_element(&expected, i) = value;
+		result = darr_packed_push(&packed, value);
+	}
+
+	result = result && darr_packed_decode(&packed, &decoded);
+
+	for (size_t i = 0; result && i < count; ++i) {
+		uint64_t e = *(uint64_t *) darr_element(&expected, i);
+
+		result = *(uint64_t *) darr_element(&decoded, i) == e
+			&& darr_packed_get(&packed, i) == e;
+	}
+
+	darr_packed_deinit(&packed);
+	darr_deinit(&expected);
+	darr_deinit(&decoded);
+
+	return result;
+}
+
+static int check_packed(void)
+{
+	for (unsigned bits = 0; bits <= 64; ++bits) {
+		if (!check_packed_bits(bits)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	enum darr_cpu_level initial = darr_cpu_level();
+	enum darr_cpu_level best = darr_cpu_detect();
+
+	// Every level the machine supports, which includes the scalar one.
+	for (enum darr_cpu_level level = DARR_CPU_SCALAR;
+		level <= best;
+		level = (enum darr_cpu_level) (level + 1)) {
+		const char *name = darr_cpu_level_name(level);
+
+		if (!darr_cpu_level_set(level) || darr_cpu_level() != level) {
+			fprintf(stderr, "Failed to set level %s.\n", name);
+			return 1;
+		}
+
+		if (!check_fill()) {
+			fprintf(stderr, "Wrong fill at level %s.\n", name);
+			return 1;
+		}
+
+		if (!check_move()) {
+			fprintf(stderr, "Wrong move at level %s.\n", name);
+			return 1;
+		}
+
+		if (!check_intersection(4) || !check_intersection(8)) {
+			fprintf(stderr, "Wrong intersection at level %s.\n", name);
+			return 1;
+		}
+
+		if (!check_bits()) {
+			fprintf(stderr, "Wrong bits at level %s.\n", name);
+			return 1;
+		}
+
+		if (!check_packed()) {
+			fprintf(stderr, "Wrong packing at level %s.\n", name);
+			return 1;
+		}
+	}
+
+	if (darr_cpu_level_set(DARR_CPU_LEVELS)
+		|| (best + 1 < DARR_CPU_LEVELS && darr_cpu_level_set(best + 1))) {
+		fprintf(stderr, "Set a level the machine does not support.\n");
+		return 1;
+	}
+
+	darr_cpu_level_set(initial);
+
+	return 0;
+}
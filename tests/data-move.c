@@ -0,0 +1,90 @@
+#include <stdio.h>
+
+#include "../src/darr_parallel.h"
+
+#define SIZE (12 << 20)
+
+static void fill(unsigned char *p, size_t size)
+{
+	for (size_t i = 0; i < size; ++i) {
+		p[i] = (unsigned char) (i * 7 + i / 251);
+	}
+}
+
+/*
+ * Shifts a slice of the array in both directions and compares the result
+ * with memmove.
+ */
+static int check(
+	struct darr *array,
+	unsigned char *expected,
+	size_t steps,
+	size_t start,
+	size_t size)
+{
+	unsigned char *p = darr_data(array);
+
+	fill(p, SIZE);
+	fill(expected, SIZE);
+	darr_shift_slice_right(array, steps, start, size);
+	memmove(expected + start + steps, expected + start, size - steps);
+
+	if (memcmp(p, expected, SIZE) != 0) {
+		return 0;
+	}
+
+	darr_shift_slice_left(array, steps, start, size);
+	memmove(expected + start, expected + start + steps, size - steps);
+
+	return memcmp(p, expected, SIZE) == 0;
+}
+
+static int check_all(struct darr *array, unsigned char *expected)
+{
+	// Small and large distances, with the ends of the slice on and off
+	// cache line boundaries.
+	return check(array, expected, 1, 0, SIZE)
+		&& check(array, expected, 3, 5, 1000)
+		&& check(array, expected, 64, 64, 64 * 100)
+		&& check(array, expected, 100, 17, 130)
+		&& check(array, expected, 4099, 1, SIZE - 1)
+		&& check(array, expected, 3 << 20, 13, SIZE - 100)
+		&& check(array, expected, SIZE / 2, 0, SIZE);
+}
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, 1);
+	darr_resize(&array, SIZE);
+
+	unsigned char *expected = malloc(SIZE);
+
+	darr_global_data_move_set(0, darr_data_move_stream);
+
+	if (!check_all(&array, expected)) {
+		fprintf(stderr, "Streaming moves differ from memmove.\n");
+		free(expected);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_parallel_threads_set(4);
+	darr_global_data_move_set(0, darr_parallel_data_move);
+
+	if (!check_all(&array, expected)) {
+		fprintf(stderr, "Parallel moves differ from memmove.\n");
+		darr_parallel_shutdown();
+		free(expected);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_global_data_move_set(DARR_DATA_MOVE_THRESHOLD, darr_data_move_stream);
+	darr_parallel_shutdown();
+
+	free(expected);
+	darr_deinit(&array);
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+/*
+ * Fills a range of an array of the given element size and checks that the
+ * elements in the range are copies of the element and the rest were kept.
+ */
+static int check(size_t element_size, size_t size, size_t start, size_t count)
+{
+	struct darr array;
+	darr_init(&array, element_size);
+
+	if (!darr_resize(&array, size)) {
+		darr_deinit(&array);
+		return 0;
+	}
+
+	unsigned char e[32];
+
+	for (size_t i = 0; i < element_size; ++i) {
+		e[i] = (unsigned char) (i * 7 + 1);
+	}
+
+	memset(darr_data(&array), 0x5a, size * element_size);
+
+	darr_fill(&array, start, count, e);
+
+	int result = 1;
+
+	for (size_t i = 0; i < size; ++i) {
+		const unsigned char *p = darr_element(&array, i);
+
+		for (size_t k = 0; k < element_size; ++k) {
+			unsigned char expected = i >= start && i < start + count
+				? e[k]
+				: 0x5a;
+
+			if (p[k] != expected) {
+				result = 0;
+			}
+		}
+	}
+
+	darr_deinit(&array);
+
+	return result;
+}
+
+int main(void)
+{
+	size_t element_sizes[] = { 1, 2, 3, 4, 8, 12, 16, 24, 32 };
+
+	for (size_t i = 0; i < sizeof(element_sizes) / sizeof(*element_sizes); ++i) {
+		size_t element_size = element_sizes[i];
+
+		// Empty, short, odd and long ranges, including ones larger than
+		// the block used when doubling.
+		if (!check(element_size, 10, 3, 0)
+			|| !check(element_size, 10, 0, 10)
+			|| !check(element_size, 100, 1, 1)
+			|| !check(element_size, 100, 3, 61)
+			|| !check(element_size, 5000, 7, 4321)
+			|| !check(element_size, 5000, 0, 5000)) {
+			fprintf(stderr, "Wrong fill for element size %zu.\n",
+				element_size);
+			return 1;
+		}
+	}
+
+	struct darr array;
+	darr_init(&array, sizeof(int));
+
+	int value = 42;
+
+	if (!darr_resize_fill(&array, 1000, &value)
+		|| darr_size(&array) != 1000) {
+		fprintf(stderr, "Failed to grow.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	int other = 7;
+
+	// Shrinking works like darr_resize and growing only fills new
+	// elements.
+	if (!darr_resize_fill(&array, 10, &other)
+		|| !darr_resize_fill(&array, 20, &other)
+		|| darr_size(&array) != 20) {
+		fprintf(stderr, "Failed to resize.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	for (size_t i = 0; i < 20; ++i) {
+		int *e = darr_element(&array, i);
+
+		if (*e != (i < 10 ? value : other)) {
+			fprintf(stderr, "Element %zu is %d.\n", i, *e);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	darr_deinit(&array);
+
+	return 0;
+}
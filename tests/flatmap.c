@@ -0,0 +1,138 @@
+#include <stdio.h>
+
+#include "../src/darr_flatmap.h"
+
+static int compare_int(const void *a, const void *b)
+{
+	int x = *(const int *) a;
+	int y = *(const int *) b;
+	return (x > y) - (x < y);
+}
+
+static int check_sorted(struct darr_flatmap *map)
+{
+	const int *keys = darr_view_data(darr_flatmap_keys(map));
+
+	for (size_t i = 1; i < darr_flatmap_size(map); ++i) {
+		if (keys[i - 1] >= keys[i]) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	struct darr_flatmap map;
+	darr_flatmap_init(&map, sizeof(int), sizeof(int), compare_int);
+
+	for (int i = 0; i < 100; ++i) {
+		int key = (i * 37) % 100;
+		int value = key * 2;
+
+		if (!darr_flatmap_insert(&map, &key, &value)) {
+			fprintf(stderr, "Failed to insert.\n");
+			darr_flatmap_deinit(&map);
+			return 1;
+		}
+	}
+
+	if (darr_flatmap_size(&map) != 100 || !check_sorted(&map)) {
+		fprintf(stderr, "Keys are not sorted after inserting.\n");
+		darr_flatmap_deinit(&map);
+		return 1;
+	}
+
+	int key = 40;
+	int value = -1;
+	darr_flatmap_insert(&map, &key, &value);
+
+	if (darr_flatmap_size(&map) != 100
+		|| *(int *) darr_flatmap_get(&map, &key) != -1) {
+		fprintf(stderr, "Inserting an existing key did not replace.\n");
+		darr_flatmap_deinit(&map);
+		return 1;
+	}
+
+	darr_flatmap_erase(&map, &key);
+
+	if (darr_flatmap_size(&map) != 99
+		|| darr_flatmap_get(&map, &key) != NULL
+		|| *(int *) darr_flatmap_get(&map, &(int) {41}) != 82) {
+		fprintf(stderr, "Erase removed the wrong entry.\n");
+		darr_flatmap_deinit(&map);
+		return 1;
+	}
+
+	// Duplicates keep the value that comes last.
+	int keys[] = {5, 3, 9, 3, 1, 5};
+	int values[] = {0, 1, 2, 3, 4, 5};
+
+	if (!darr_flatmap_build(
+		&map,
+		darr_view_from(keys, 6, sizeof(int)),
+		darr_view_from(values, 6, sizeof(int)))) {
+		fprintf(stderr, "Failed to build.\n");
+		darr_flatmap_deinit(&map);
+		return 1;
+	}
+
+	int expected_keys[] = {1, 3, 5, 9};
+	int expected_values[] = {4, 3, 5, 2};
+
+	for (size_t i = 0; i < 4; ++i) {
+		if (darr_flatmap_size(&map) != 4
+			|| *(const int *) darr_flatmap_key(&map, i)
+				!= expected_keys[i]
+			|| *(int *) darr_flatmap_value(&map, i)
+				!= expected_values[i]) {
+			fprintf(stderr, "Build produced the wrong entries.\n");
+			darr_flatmap_deinit(&map);
+			return 1;
+		}
+	}
+
+	struct darr_flatmap other;
+	darr_flatmap_init(&other, sizeof(int), sizeof(int), compare_int);
+	darr_flatmap_insert(&other, &(int) {3}, &(int) {30});
+	darr_flatmap_insert(&other, &(int) {7}, &(int) {70});
+
+	struct darr_flatmap merged;
+	darr_flatmap_init(&merged, sizeof(int), sizeof(int), compare_int);
+
+	if (!darr_flatmap_merge(&merged, &map, &other)
+		|| darr_flatmap_size(&merged) != 5
+		|| !check_sorted(&merged)
+		|| *(int *) darr_flatmap_get(&merged, &(int) {3}) != 30
+		|| *(int *) darr_flatmap_get(&merged, &(int) {7}) != 70) {
+		fprintf(stderr, "Merge produced the wrong entries.\n");
+		darr_flatmap_deinit(&merged);
+		darr_flatmap_deinit(&other);
+		darr_flatmap_deinit(&map);
+		return 1;
+	}
+
+	darr_flatmap_deinit(&merged);
+	darr_flatmap_deinit(&other);
+	darr_flatmap_deinit(&map);
+
+	struct darr_flatmap set;
+	darr_flatmap_init(&set, sizeof(int), 0, compare_int);
+
+	if (!darr_flatmap_build(
+		&set,
+		darr_view_from(keys, 6, sizeof(int)),
+		darr_view_from(NULL, 0, 0))
+		|| darr_flatmap_size(&set) != 4
+		|| darr_flatmap_find(&set, &(int) {9}) != 3
+		|| darr_flatmap_find(&set, &(int) {4}) != 4) {
+		fprintf(stderr, "Set does not hold the right keys.\n");
+		darr_flatmap_deinit(&set);
+		return 1;
+	}
+
+	darr_flatmap_deinit(&set);
+
+	return 0;
+}
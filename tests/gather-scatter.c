@@ -0,0 +1,68 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+int main(void)
+{
+	struct darr src;
+	darr_init(&src, sizeof(double));
+	darr_resize(&src, 100);
+
+	for (int i = 0; i < 100; ++i) {
+		*(double *) darr_element(&src, i) = i * 1.5;
+	}
+
+	struct darr idx;
+	darr_init(&idx, sizeof(size_t));
+	darr_resize(&idx, 100);
+
+	// A permutation.
+	for (size_t i = 0; i < 100; ++i) {
+		*(size_t *) darr_element(&idx, i) = i * 37 % 100;
+	}
+
+	struct darr gathered;
+	darr_init(&gathered, sizeof(double));
+
+	if (!darr_gather(&gathered, &src, &idx) || darr_size(&gathered) != 100) {
+		fprintf(stderr, "Failed to gather.\n");
+		darr_deinit(&gathered);
+		darr_deinit(&idx);
+		darr_deinit(&src);
+		return 1;
+	}
+
+	for (size_t i = 0; i < 100; ++i) {
+		if (*(double *) darr_element(&gathered, i) != i * 37 % 100 * 1.5) {
+			fprintf(stderr, "Wrong value for gathered element %zu.\n", i);
+			darr_deinit(&gathered);
+			darr_deinit(&idx);
+			darr_deinit(&src);
+			return 1;
+		}
+	}
+
+	// Scattering with the same permutation undoes the gather.
+	struct darr scattered;
+	darr_init(&scattered, sizeof(double));
+	darr_resize(&scattered, 100);
+	darr_scatter(&scattered, &gathered, &idx);
+
+	for (int i = 0; i < 100; ++i) {
+		if (*(double *) darr_element(&scattered, i) != i * 1.5) {
+			fprintf(stderr, "Wrong value for scattered element %d.\n", i);
+			darr_deinit(&scattered);
+			darr_deinit(&gathered);
+			darr_deinit(&idx);
+			darr_deinit(&src);
+			return 1;
+		}
+	}
+
+	darr_deinit(&scattered);
+	darr_deinit(&gathered);
+	darr_deinit(&idx);
+	darr_deinit(&src);
+
+	return 0;
+}
@@ -0,0 +1,22 @@
+#define DARR_HEADER_ONLY
+#include "../src/darr.h"
+
+int header_only_other(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+
+	int value = 3;
+
+	if (!darr_resize_fill(&array, 100, &value)) {
+		return 0;
+	}
+
+	darr_rotate(&array, 0, 100, 10);
+
+	int result = *(int *) darr_element(&array, 99) == value;
+
+	darr_deinit(&array);
+
+	return result;
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+static size_t reallocs;
+static size_t frees;
+
+static void *counting_realloc(void *p, size_t size)
+{
+	reallocs += 1;
+	return realloc(p, size);
+}
+
+static void counting_free(void *p)
+{
+	frees += 1;
+	free(p);
+}
+
+#define DARR_HEADER_ONLY
+#define DARR_REALLOC counting_realloc
+#define DARR_FREE counting_free
+#include "../src/darr.h"
+
+/*
+ * Defined in header-only-other.c, which also includes darr.h in header only
+ * mode, to check that both files link into the same program.
+ */
+int header_only_other(void);
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+
+	int value = 7;
+
+	// Goes through functions that are defined in darr.c.
+	if (!darr_resize_fill(&array, 1000, &value)
+		|| !darr_resize_zeroed(&array, 2000)) {
+		fprintf(stderr, "Failed to resize.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_reverse(&array, 0, 2000);
+
+	for (size_t i = 0; i < 2000; ++i) {
+		int *e = darr_element(&array, i);
+
+		if (*e != (i < 1000 ? 0 : value)) {
+			fprintf(stderr, "Element %zu is %d.\n", i, *e);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	darr_deinit(&array);
+
+	// Setting the global allocator has no effect with DARR_REALLOC.
+	darr_global_realloc_set(NULL);
+	darr_global_free_set(NULL);
+
+	darr_init(&array, sizeof(int));
+
+	if (!darr_resize(&array, 10)) {
+		fprintf(stderr, "Failed to allocate.\n");
+		return 1;
+	}
+
+	darr_deinit(&array);
+
+	if (reallocs == 0 || frees != 2) {
+		fprintf(stderr, "%zu reallocs and %zu frees.\n", reallocs, frees);
+		return 1;
+	}
+
+	if (!header_only_other()) {
+		fprintf(stderr, "Failed in the other file.\n");
+		return 1;
+	}
+
+	return 0;
+}
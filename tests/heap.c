@@ -0,0 +1,125 @@
+#include <stdio.h>
+
+#include "../src/darr_heap.h"
+
+struct big {
+	int key;
+	char padding[100];
+};
+
+static int compare_int(const void *a, const void *b)
+{
+	int x = *(const int *) a;
+	int y = *(const int *) b;
+	return (x > y) - (x < y);
+}
+
+static int check_pops_sorted(struct darr *array, size_t arity)
+{
+	int previous = -1;
+	int value;
+
+	while (!darr_empty(array)) {
+		darr_heap_pop(array, arity, compare_int, &value);
+
+		if (value < previous) {
+			return 0;
+		}
+
+		previous = value;
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	size_t arities[] = {2, 4, 8};
+
+	for (size_t a = 0; a < 3; ++a) {
+		size_t arity = arities[a];
+		struct darr array;
+		darr_init(&array, sizeof(int));
+
+		for (int i = 0; i < 500; ++i) {
+			int value = (i * 7919) % 1000;
+			darr_heap_push(&array, arity, compare_int, &value);
+		}
+
+		if (*(int *) darr_first(&array) != 0) {
+			fprintf(stderr, "Push did not keep the smallest on top.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		if (!check_pops_sorted(&array, arity)) {
+			fprintf(stderr, "Pushed elements popped out of order.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		darr_resize(&array, 500);
+
+		for (int i = 0; i < 500; ++i) {
+			*(int *) darr_element(&array, i) = 500 - i;
+		}
+
+		darr_heapify(&array, arity, compare_int);
+
+		// Moves an element to the top and another to the bottom.
+		*(int *) darr_element(&array, 250) = -5;
+		darr_heap_update(&array, arity, compare_int, 250);
+		*(int *) darr_element(&array, 0) = 10000;
+		darr_heap_update(&array, arity, compare_int, 0);
+
+		if (*(int *) darr_first(&array) != 1) {
+			fprintf(stderr, "Update did not restore the heap.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		int top;
+		darr_heap_replace(&array, arity, compare_int, &(int) {600}, &top);
+
+		if (top != 1 || darr_size(&array) != 500
+			|| *(int *) darr_first(&array) <= 1) {
+			fprintf(stderr, "Replace did not swap the top.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		if (!check_pops_sorted(&array, arity)) {
+			fprintf(stderr, "Heapified elements popped out of order.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		if (darr_heap_pop(&array, arity, compare_int, NULL)) {
+			fprintf(stderr, "Popped from an empty heap.\n");
+			darr_deinit(&array);
+			return 1;
+		}
+
+		darr_deinit(&array);
+	}
+
+	// Elements too large for the stack buffer.
+	struct darr array;
+	darr_init(&array, sizeof(struct big));
+	darr_resize(&array, 100);
+
+	for (int i = 0; i < 100; ++i) {
+		((struct big *) darr_element(&array, i))->key = 100 - i;
+	}
+
+	if (!darr_heapify(&array, 4, compare_int)
+		|| ((struct big *) darr_first(&array))->key != 1) {
+		fprintf(stderr, "Failed to heapify large elements.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_deinit(&array);
+
+	return 0;
+}
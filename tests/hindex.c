@@ -0,0 +1,89 @@
+#include <stddef.h>
+#include <stdio.h>
+
+#include "../src/darr_hindex.h"
+
+struct record {
+	double value;
+	int key;
+};
+
+static size_t find(struct darr_hindex *index, struct darr *array, int key)
+{
+	return darr_hindex_find(index, array, &key);
+}
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(struct record));
+	darr_resize(&array, 1000);
+
+	struct record *records = darr_data(&array);
+
+	for (int i = 0; i < 1000; ++i) {
+		records[i].key = i * 7;
+		records[i].value = i;
+	}
+
+	struct darr_hindex index;
+	darr_hindex_init(&index, offsetof(struct record, key), sizeof(int));
+
+	if (!darr_hindex_build(&index, &array)) {
+		fprintf(stderr, "Failed to build index.\n");
+		darr_hindex_deinit(&index);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	for (int i = 0; i < 1000; ++i) {
+		if (find(&index, &array, i * 7) != (size_t) i) {
+			fprintf(stderr, "Key %d was not found.\n", i * 7);
+			darr_hindex_deinit(&index);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	if (find(&index, &array, 1) != darr_size(&array)) {
+		fprintf(stderr, "Found a key that is not there.\n");
+		darr_hindex_deinit(&index);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	// The last element moves to index 10.
+	darr_hindex_swap_remove(&index, &array, 10);
+
+	if (find(&index, &array, 70) != darr_size(&array)
+		|| find(&index, &array, 999 * 7) != 10) {
+		fprintf(stderr, "Index was not updated by swap remove.\n");
+		darr_hindex_deinit(&index);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	for (int i = 0; i < 2000; ++i) {
+		struct record r = { 0, -i - 1 };
+
+		if (!darr_hindex_push(&index, &array, &r)) {
+			fprintf(stderr, "Failed to push.\n");
+			darr_hindex_deinit(&index);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	if (darr_hindex_size(&index) != 2999
+		|| find(&index, &array, -2000) != darr_size(&array) - 1
+		|| find(&index, &array, 14) != 2) {
+		fprintf(stderr, "Index was not updated by push.\n");
+		darr_hindex_deinit(&index);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_hindex_deinit(&index);
+	darr_deinit(&array);
+	return 0;
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 4);
+
+	int *element = darr_element(&array, 0);
+
+	element[0] = 0;
+	element[1] = 3;
+	element[2] = 6;
+	element[3] = 9;
+
+	int a[] = { 1, 2 };
+	int b[] = { 4, 5 };
+	int c[] = { 7 };
+	int e[] = { 8 };
+	int f[] = { 10 };
+
+	struct darr_insert_op ops[] = {
+		{ 1, a, 2 },
+		{ 2, b, 2 },
+		{ 3, c, 1 },
+		{ 3, e, 1 },
+		{ 4, f, 1 },
+	};
+
+	if (!darr_insert_many(&array, ops, 5)) {
+		fprintf(stderr, "Failed to insert.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	if (darr_size(&array) != 11) {
+		fprintf(stderr, "Wrong size after inserting.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	element = darr_element(&array, 0);
+
+	for (int i = 0; i < 11; ++i) {
+		if (element[i] != i) {
+			fprintf(stderr, "Element %d does not have the expected value.\n", i);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	darr_deinit(&array);
+	return 0;
+}
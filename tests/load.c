@@ -0,0 +1,123 @@
+#include <stdio.h>
+
+#include "../src/darr_load.h"
+
+#define PATH "load-test.bin"
+#define COUNT 3000000
+
+struct progress {
+	size_t next;
+	int in_order;
+};
+
+static int check_chunk(void *ctx, void *elements, size_t start, size_t count)
+{
+	struct progress *p = ctx;
+	const int *e = elements;
+
+	if (start != p->next) {
+		p->in_order = 0;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		if (e[i] != (int) (start + i)) {
+			p->in_order = 0;
+		}
+	}
+
+	p->next = start + count;
+	return 1;
+}
+
+static int stop(void *ctx, void *elements, size_t start, size_t count)
+{
+	(void) ctx;
+	(void) elements;
+	(void) start;
+	(void) count;
+	return 0;
+}
+
+static int load(struct darr *array, int flags)
+{
+	struct progress p = { 0, 1 };
+
+	return darr_load_file(array, PATH, flags, check_chunk, &p)
+		&& p.in_order
+		&& p.next == COUNT
+		&& darr_size(array) == COUNT
+		&& *(int *) darr_last(array) == COUNT - 1;
+}
+
+int main(void)
+{
+	FILE *f = fopen(PATH, "wb");
+
+	for (int i = 0; i < COUNT; ++i) {
+		fwrite(&i, sizeof(i), 1, f);
+	}
+
+	fclose(f);
+
+	struct darr array;
+	darr_init(&array, sizeof(int));
+
+	if (!load(&array, 0)) {
+		fprintf(stderr, "Failed to load the file.\n");
+		darr_deinit(&array);
+		remove(PATH);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_init(&array, sizeof(int));
+
+	if (!load(&array, DARR_LOAD_SYNC)) {
+		fprintf(stderr, "Failed to load the file with pread.\n");
+		darr_deinit(&array);
+		remove(PATH);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_init_aligned(&array, sizeof(int), 4096, 4096);
+
+	if (!load(&array, DARR_LOAD_DIRECT)) {
+		fprintf(stderr, "Failed to load the file with O_DIRECT.\n");
+		darr_deinit(&array);
+		remove(PATH);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_init(&array, sizeof(int));
+
+	if (darr_load_file(&array, PATH, 0, stop, NULL)
+		|| !darr_empty(&array)) {
+		fprintf(stderr, "Loading did not stop.\n");
+		darr_deinit(&array);
+		remove(PATH);
+		return 1;
+	}
+
+	darr_deinit(&array);
+
+	// The size of the file is not a multiple of 8.
+	darr_init(&array, 8);
+
+	f = fopen(PATH, "ab");
+	fputc(0, f);
+	fclose(f);
+
+	if (darr_load_file(&array, PATH, 0, NULL, NULL)) {
+		fprintf(stderr, "Loaded a partial element.\n");
+		darr_deinit(&array);
+		remove(PATH);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	remove(PATH);
+
+	return 0;
+}
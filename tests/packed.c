@@ -0,0 +1,83 @@
+#include <stdio.h>
+
+#include "../src/darr_packed.h"
+
+int main(void)
+{
+	struct darr values;
+	darr_init(&values, sizeof(uint64_t));
+	darr_resize(&values, 1000);
+
+	// Gaps of different sizes so that blocks use different bit widths,
+	// including a block of equal values and one with huge gaps.
+	uint64_t value = UINT64_C(1) << 40;
+
+	for (size_t i = 0; i < 1000; ++i) {
+		if (i >= 256 && i < 384) {
+			value += 0;
+		} else if (i >= 512 && i < 640) {
+			value += UINT64_C(1) << 50;
+		} else {
+			value += i % 7 + i / 100;
+		}
+
+		*(uint64_t *) darr_element(&values, i) = value;
+	}
+
+	struct darr_packed packed;
+	darr_packed_init(&packed);
+
+	if (!darr_packed_append_view(&packed, darr_view_all(&values))
+		|| darr_packed_size(&packed) != 1000) {
+		fprintf(stderr, "Failed to append values.\n");
+		darr_packed_deinit(&packed);
+		darr_deinit(&values);
+		return 1;
+	}
+
+	for (size_t i = 0; i < 1000; ++i) {
+		if (darr_packed_get(&packed, i)
+			!= *(uint64_t *) darr_element(&values, i)) {
+			fprintf(stderr, "Value %zu is wrong.\n", i);
+			darr_packed_deinit(&packed);
+			darr_deinit(&values);
+			return 1;
+		}
+	}
+
+	if (darr_packed_bytes(&packed) >= 1000 * sizeof(uint64_t)) {
+		fprintf(stderr, "Values were not compressed.\n");
+		darr_packed_deinit(&packed);
+		darr_deinit(&values);
+		return 1;
+	}
+
+	if (darr_packed_push(&packed, 0)) {
+		fprintf(stderr, "Pushed a value smaller than the last.\n");
+		darr_packed_deinit(&packed);
+		darr_deinit(&values);
+		return 1;
+	}
+
+	struct darr decoded;
+	darr_init(&decoded, sizeof(uint64_t));
+
+	if (!darr_packed_decode(&packed, &decoded)
+		|| darr_size(&decoded) != 1000
+		|| memcmp(
+			darr_data(&decoded),
+			darr_data(&values),
+			1000 * sizeof(uint64_t)) != 0) {
+		fprintf(stderr, "Decoded values differ.\n");
+		darr_deinit(&decoded);
+		darr_packed_deinit(&packed);
+		darr_deinit(&values);
+		return 1;
+	}
+
+	darr_deinit(&decoded);
+	darr_packed_deinit(&packed);
+	darr_deinit(&values);
+
+	return 0;
+}
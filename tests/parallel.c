@@ -0,0 +1,133 @@
+#include <stdio.h>
+
+#include "../src/darr_parallel.h"
+
+static void double_all(void *ctx, void *elements, size_t start, size_t count)
+{
+	int *e = elements;
+	(void) ctx;
+	(void) start;
+
+	for (size_t i = 0; i < count; ++i) {
+		e[i] *= 2;
+	}
+}
+
+static void sum(
+	void *ctx,
+	void *acc,
+	const void *elements,
+	size_t start,
+	size_t count)
+{
+	const int *e = elements;
+	(void) ctx;
+	(void) start;
+
+	for (size_t i = 0; i < count; ++i) {
+		*(long long *) acc += e[i];
+	}
+}
+
+static void add(void *ctx, void *acc, const void *other)
+{
+	(void) ctx;
+	*(long long *) acc += *(const long long *) other;
+}
+
+static void halve(
+	void *ctx,
+	void *dst,
+	const void *src,
+	size_t start,
+	size_t count)
+{
+	double *d = dst;
+	const int *s = src;
+	(void) ctx;
+	(void) start;
+
+	for (size_t i = 0; i < count; ++i) {
+		d[i] = s[i] / 2.0;
+	}
+}
+
+static void nested(void *ctx, void *elements, size_t start, size_t count)
+{
+	struct darr copy;
+	(void) ctx;
+	(void) start;
+
+	darr_init(&copy, sizeof(int));
+	darr_resize(&copy, count);
+	memcpy(darr_data(&copy), elements, count * sizeof(int));
+
+	// Runs on the calling thread since it comes from inside a call.
+	darr_parallel_for(&copy, double_all, NULL, 1);
+
+	memcpy(elements, darr_data(&copy), count * sizeof(int));
+	darr_deinit(&copy);
+}
+
+int main(void)
+{
+	darr_parallel_threads_set(4);
+
+	struct darr array;
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 100000);
+
+	for (int i = 0; i < 100000; ++i) {
+		*(int *) darr_element(&array, i) = i;
+	}
+
+	darr_parallel_for(&array, double_all, NULL, 0);
+
+	for (int i = 0; i < 100000; ++i) {
+		if (*(int *) darr_element(&array, i) != i * 2) {
+			fprintf(stderr, "Element %d was not doubled once.\n", i);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	long long total = 0;
+
+	if (!darr_parallel_reduce(
+		&array, sum, add, NULL, &total, sizeof(total), 1000)
+		|| total != 99999LL * 100000) {
+		fprintf(stderr, "Reduce returned %lld.\n", total);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	struct darr halves;
+	darr_init(&halves, sizeof(double));
+
+	if (!darr_parallel_transform(&halves, &array, halve, NULL, 0)
+		|| darr_size(&halves) != 100000
+		|| *(double *) darr_element(&halves, 4321) != 4321) {
+		fprintf(stderr, "Transform produced the wrong elements.\n");
+		darr_deinit(&halves);
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_deinit(&halves);
+
+	darr_parallel_for(&array, nested, NULL, 0);
+
+	for (int i = 0; i < 100000; ++i) {
+		if (*(int *) darr_element(&array, i) != i * 4) {
+			fprintf(stderr, "Nested call did not double %d.\n", i);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	darr_deinit(&array);
+
+	darr_parallel_shutdown();
+
+	return 0;
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+
+#include "../src/darr_pvec.h"
+
+#define VERSIONS 5
+
+/*
+ * An element size that is not a power of two.
+ */
+struct element {
+	char bytes[3];
+};
+
+static struct element make(size_t value, size_t version)
+{
+	struct element e = { {
+		(char) value,
+		(char) (value >> 8),
+		(char) version,
+	} };
+	return e;
+}
+
+static int is(const void *p, size_t value, size_t version)
+{
+	struct element e = make(value, version);
+	return memcmp(p, &e, sizeof(e)) == 0;
+}
+
+int main(void)
+{
+	struct darr_pvec versions[VERSIONS];
+	size_t size = 40000;
+
+	// Version 0 is built one element at a time.
+	darr_pvec_init(&versions[0], sizeof(struct element));
+
+	for (size_t i = 0; i < size; ++i) {
+		struct element e = make(i, 0);
+
+		if (!darr_pvec_push(&versions[0], &versions[0], &e)) {
+			fprintf(stderr, "Failed to push.\n");
+			return 1;
+		}
+	}
+
+	// Every other version changes every 7th element of the one before.
+	for (size_t v = 1; v < VERSIONS; ++v) {
+		darr_pvec_copy(&versions[v], &versions[v - 1]);
+
+		for (size_t i = v; i < size; i += 7) {
+			struct element e = make(i, v);
+
+			if (!darr_pvec_set(&versions[v], &versions[v], i, &e)) {
+				fprintf(stderr, "Failed to set.\n");
+				return 1;
+			}
+		}
+	}
+
+	for (size_t v = 0; v < VERSIONS; ++v) {
+		if (darr_pvec_size(&versions[v]) != size) {
+			fprintf(stderr, "Version %zu has the wrong size.\n", v);
+			return 1;
+		}
+
+		for (size_t i = 0; i < size; ++i) {
+			// The last version that changed the element.
+			size_t changed = 0;
+
+			for (size_t w = 1; w <= v; ++w) {
+				if (i >= w && (i - w) % 7 == 0) {
+					changed = w;
+				}
+			}
+
+			if (!is(darr_pvec_get(&versions[v], i), i, changed)) {
+				fprintf(stderr, "Version %zu has the wrong element %zu.\n",
+					v, i);
+				return 1;
+			}
+		}
+	}
+
+	// Indexes past the size, including one past the capacity of the root.
+	struct element past = make(size, 0);
+
+	if (darr_pvec_set(&versions[0], &versions[0], size, &past)
+		|| darr_pvec_transient_set(&versions[0], SIZE_MAX, &past)
+		|| darr_pvec_size(&versions[0]) != size) {
+		fprintf(stderr, "Set an element past the size.\n");
+		return 1;
+	}
+
+	// Transient changes leave the versions it shares nodes with alone.
+	struct darr_pvec batch;
+	darr_pvec_copy(&batch, &versions[0]);
+
+	for (size_t i = 0; i < size; ++i) {
+		struct element e = make(i, 9);
+
+		if (!darr_pvec_transient_set(&batch, i, &e)) {
+			fprintf(stderr, "Failed to set in place.\n");
+			return 1;
+		}
+	}
+
+	for (size_t i = size; i < size + 100; ++i) {
+		struct element e = make(i, 9);
+
+		if (!darr_pvec_transient_push(&batch, &e)) {
+			fprintf(stderr, "Failed to push in place.\n");
+			return 1;
+		}
+	}
+
+	for (size_t i = 0; i < size + 100; ++i) {
+		if (!is(darr_pvec_get(&batch, i), i, 9)
+			|| (i < size && !is(darr_pvec_get(&versions[0], i), i, 0))) {
+			fprintf(stderr, "Changing in place affected another version.\n");
+			return 1;
+		}
+	}
+
+	// Conversions, with sizes around the boundaries of leaves and levels.
+	size_t sizes[] = { 0, 1, 32, 33, 1024, 1025, 32768, 32769 };
+	struct darr array;
+	struct darr flat;
+	darr_init(&array, sizeof(struct element));
+	darr_init(&flat, sizeof(struct element));
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		darr_resize(&array, sizes[s]);
+
+		for (size_t i = 0; i < sizes[s]; ++i) {
+			*(struct element *) darr_element(&array, i) = make(i, 3);
+		}
+
+		struct darr_pvec converted;
+		darr_pvec_init(&converted, sizeof(struct element));
+
+		if (!darr_pvec_from_darr(&converted, &array)
+			|| darr_pvec_size(&converted) != sizes[s]
+			|| !darr_pvec_to_darr(&flat, &converted)
+			|| darr_size(&flat) != sizes[s]
+			|| memcmp(darr_data(&flat), darr_data(&array),
+				sizes[s] * sizeof(struct element)) != 0) {
+			fprintf(stderr, "Conversion of %zu elements failed.\n",
+				sizes[s]);
+			return 1;
+		}
+
+		// A converted version grows like any other.
+		struct element e = make(sizes[s], 4);
+
+		if (!darr_pvec_push(&converted, &converted, &e)
+			|| !is(darr_pvec_get(&converted, sizes[s]), sizes[s], 4)
+			|| (sizes[s] > 0
+				&& !is(darr_pvec_get(&converted, 0), 0, 3))) {
+			fprintf(stderr, "Failed to push after converting %zu "
+				"elements.\n", sizes[s]);
+			return 1;
+		}
+
+		darr_pvec_deinit(&converted);
+	}
+
+	darr_deinit(&array);
+	darr_deinit(&flat);
+	darr_pvec_deinit(&batch);
+
+	for (size_t v = 0; v < VERSIONS; ++v) {
+		darr_pvec_deinit(&versions[v]);
+	}
+
+	return 0;
+}
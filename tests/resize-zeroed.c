@@ -0,0 +1,101 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+static size_t reallocs;
+
+static void *counting_realloc(void *p, size_t size)
+{
+	reallocs += 1;
+	return realloc(p, size);
+}
+
+/*
+ * Sets every byte of the array, grows it and checks that the old elements
+ * were kept and the new ones are zero.
+ */
+static int check(struct darr *array, size_t old_size, size_t size)
+{
+	if (!darr_resize(array, old_size)) {
+		return 0;
+	}
+
+	memset(darr_data(array), 0x5a, old_size * array->element_size);
+
+	if (!darr_grow_zeroed(array, size - old_size)
+		|| darr_size(array) != size) {
+		return 0;
+	}
+
+	const unsigned char *p = darr_data(array);
+
+	for (size_t i = 0; i < size * array->element_size; ++i) {
+		if (p[i] != (i < old_size * array->element_size ? 0x5a : 0)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+
+	// Grown with memset, from an empty array with calloc and grown into a
+	// fresh buffer with calloc.
+	if (!check(&array, 10, 20)
+		|| !check(&array, 0, 1 << 20)
+		|| !check(&array, 1000, 1 << 20)) {
+		fprintf(stderr, "New elements are not zero.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	// Shrinking works like darr_resize.
+	if (!darr_resize_zeroed(&array, 5) || darr_size(&array) != 5) {
+		fprintf(stderr, "Failed to shrink.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_init_aligned(&array, sizeof(int), 64, 32);
+
+	if (!check(&array, 1000, 1 << 20)
+		|| (uintptr_t) darr_data(&array) % 64 != 0) {
+		fprintf(stderr, "Aligned arrays are not zeroed.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_deinit(&array);
+
+	// A custom realloc turns calloc off so every buffer comes from it.
+	darr_global_realloc_set(counting_realloc);
+	darr_init(&array, sizeof(int));
+
+	if (!check(&array, 1000, 1 << 20) || reallocs == 0) {
+		fprintf(stderr, "Custom realloc was not used.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_global_realloc_set(realloc);
+	darr_global_calloc_set(calloc);
+
+	// So does a custom free.
+	darr_global_free_set(free);
+
+	if (darr_calloc != NULL) {
+		fprintf(stderr, "Custom free did not turn calloc off.\n");
+		darr_global_calloc_set(calloc);
+		return 1;
+	}
+
+	darr_global_calloc_set(calloc);
+
+	return 0;
+}
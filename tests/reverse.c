@@ -0,0 +1,59 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+struct triple {
+	char bytes[3];
+};
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 7);
+
+	int *element = darr_data(&array);
+
+	for (int i = 0; i < 7; ++i) {
+		element[i] = i;
+	}
+
+	darr_reverse(&array, 1, 5);
+
+	int expected[] = {0, 5, 4, 3, 2, 1, 6};
+
+	for (int i = 0; i < 7; ++i) {
+		if (element[i] != expected[i]) {
+			fprintf(stderr, "Wrong value for element %d after reverse.\n", i);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	darr_deinit(&array);
+
+	// An element size that has no specialized loop.
+	darr_init(&array, sizeof(struct triple));
+	darr_resize(&array, 4);
+
+	struct triple *triples = darr_data(&array);
+
+	for (int i = 0; i < 4; ++i) {
+		triples[i].bytes[0] = (char) i;
+		triples[i].bytes[2] = (char) -i;
+	}
+
+	darr_reverse(&array, 0, 4);
+
+	for (int i = 0; i < 4; ++i) {
+		if (triples[i].bytes[0] != 3 - i || triples[i].bytes[2] != i - 3) {
+			fprintf(stderr, "Wrong value for triple %d after reverse.\n", i);
+			darr_deinit(&array);
+			return 1;
+		}
+	}
+
+	darr_deinit(&array);
+
+	return 0;
+}
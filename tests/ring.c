@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../src/darr_ring.h"
+
+/*
+ * Records large enough that a batch of them spans many cache lines.
+ */
+struct record {
+	uint64_t sequence;
+	uint64_t check;
+	char padding[16];
+};
+
+#define RECORDS 200000
+
+static void *produce(void *arg)
+{
+	struct darr_ring *r = arg;
+	struct record batch[37];
+	uint64_t next = 0;
+	size_t pending = 0;
+	size_t sent = 0;
+
+	while (next < RECORDS || sent < pending) {
+		if (sent == pending) {
+			// Batches of every size up to 37 so that spans start and
+			// end all over the buffer.
+			pending = next % 37 + 1;
+			sent = 0;
+
+			if (pending > RECORDS - next) {
+				pending = RECORDS - next;
+			}
+
+			for (size_t i = 0; i < pending; ++i) {
+				batch[i].sequence = next;
+				batch[i].check = ~next;
+				next += 1;
+			}
+		}
+
+		size_t n = darr_ring_push(r, batch + sent, pending - sent);
+
+		// Lets the consumer run when both share a core.
+		if (n == 0) {
+			sched_yield();
+		}
+
+		sent += n;
+	}
+
+	return NULL;
+}
+
+int main(void)
+{
+	struct darr_ring r;
+
+	if (!darr_ring_init(&r, sizeof(struct record), 100)) {
+		fprintf(stderr, "Failed to initialize.\n");
+		return 1;
+	}
+
+	if (darr_ring_capacity(&r) != 128 || darr_ring_size(&r) != 0) {
+		fprintf(stderr, "Capacity is not rounded up.\n");
+		darr_ring_deinit(&r);
+		return 1;
+	}
+
+	// A single thread fills the queue, wraps around and empties it.
+	struct record in[200];
+	struct record out[200];
+
+	for (size_t i = 0; i < 200; ++i) {
+		in[i].sequence = i;
+	}
+
+	if (darr_ring_push(&r, in, 100) != 100
+		|| darr_ring_pop(&r, out, 60) != 60
+		|| darr_ring_push(&r, in + 100, 100) != 88
+		|| darr_ring_size(&r) != 128
+		|| darr_ring_push(&r, in + 188, 1) != 0
+		|| darr_ring_pop(&r, out + 60, 200) != 128
+		|| darr_ring_pop(&r, out, 1) != 0) {
+		fprintf(stderr, "Wrong number of elements pushed or popped.\n");
+		darr_ring_deinit(&r);
+		return 1;
+	}
+
+	for (size_t i = 0; i < 188; ++i) {
+		if (out[i].sequence != i) {
+			fprintf(stderr, "Popped %llu instead of %zu.\n",
+				(unsigned long long) out[i].sequence, i);
+			darr_ring_deinit(&r);
+			return 1;
+		}
+	}
+
+	// A producer and a consumer on different threads.
+	pthread_t producer;
+
+	if (pthread_create(&producer, NULL, produce, &r) != 0) {
+		fprintf(stderr, "Failed to create thread.\n");
+		darr_ring_deinit(&r);
+		return 1;
+	}
+
+	uint64_t expected = 0;
+
+	while (expected < RECORDS) {
+		size_t n = darr_ring_pop(&r, out, expected % 53 + 1);
+
+		if (n == 0) {
+			sched_yield();
+		}
+
+		for (size_t i = 0; i < n; ++i) {
+			if (out[i].sequence != expected
+				|| out[i].check != ~expected) {
+				fprintf(stderr, "Popped %llu instead of %llu.\n",
+					(unsigned long long) out[i].sequence,
+					(unsigned long long) expected);
+				return 1;
+			}
+
+			expected += 1;
+		}
+	}
+
+	pthread_join(producer, NULL);
+
+	if (darr_ring_size(&r) != 0) {
+		fprintf(stderr, "Elements left over.\n");
+		darr_ring_deinit(&r);
+		return 1;
+	}
+
+	darr_ring_deinit(&r);
+
+	return 0;
+}
@@ -0,0 +1,50 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+static int check(struct darr *array, size_t start, size_t size, size_t k)
+{
+	int *element = darr_data(array);
+
+	for (size_t i = 0; i < darr_size(array); ++i) {
+		element[i] = (int) i;
+	}
+
+	darr_rotate(array, start, size, k);
+
+	for (size_t i = 0; i < darr_size(array); ++i) {
+		size_t expected = i;
+
+		if (i >= start && i < start + size) {
+			expected = start + (i - start + k) % size;
+		}
+
+		if (element[i] != (int) expected) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 1000);
+
+	// Small left part, small right part and both parts large.
+	if (!check(&array, 10, 900, 3)
+		|| !check(&array, 10, 900, 897)
+		|| !check(&array, 10, 900, 400)
+		|| !check(&array, 0, 1000, 1000)
+		|| !check(&array, 0, 1000, 1001)) {
+		fprintf(stderr, "Wrong values after rotate.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_deinit(&array);
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../src/darr_seq.h"
+
+/*
+ * Large elements make small leaves, so that the tree grows a few levels
+ * with few elements.
+ */
+struct element {
+	uint32_t value;
+	char padding[124];
+};
+
+static uint32_t next_random(uint32_t *state)
+{
+	*state = *state * 1664525 + 1013904223;
+	return *state >> 8;
+}
+
+/*
+ * Compares the sequence with the array through every way of reading it.
+ */
+static int same(struct darr_seq *s, struct darr *expected, struct darr *flat)
+{
+	size_t size = darr_size(expected);
+
+	if (darr_seq_size(s) != size
+		|| !darr_seq_flatten(flat, s)
+		|| darr_size(flat) != size
+		|| memcmp(darr_data(flat), darr_data(expected),
+			size * sizeof(struct element)) != 0) {
+		return 0;
+	}
+
+	size_t count;
+
+	for (size_t i = 0; i < size; i += count) {
+		struct element *block = darr_seq_block(s, i, &count);
+
+		if (count == 0 || i + count > size
+			|| block->value
+				!= ((struct element *) darr_element(expected, i))->value) {
+			return 0;
+		}
+	}
+
+	for (size_t i = 0; i < size; i += 7) {
+		struct element *e = darr_seq_element(s, i);
+
+		if (e->value
+			!= ((struct element *) darr_element(expected, i))->value) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Applies random edits to the sequence and to an array and checks that they
+ * stay the same.
+ */
+static int check(
+	struct darr_seq *s,
+	struct darr *expected,
+	struct darr *batch,
+	struct darr *flat)
+{
+	uint32_t state = 1;
+	uint32_t counter = 0;
+
+	for (int op = 0; op < 1000; ++op) {
+		size_t size = darr_size(expected);
+		uint32_t kind = next_random(&state) % 10;
+
+		// Mostly small edits and a few large ones, with more inserts
+		// than removals early on so that the tree grows first.
+		size_t count = kind == 0
+			? next_random(&state) % 500 + 1
+			: next_random(&state) % 40 + 1;
+
+		if (op < 500 ? kind < 7 : kind < 4) {
+			size_t i = next_random(&state) % (size + 1);
+
+			darr_resize(batch, count);
+
+			for (size_t k = 0; k < count; ++k) {
+				struct element *e = darr_element(batch, k);
+				memset(e, 0, sizeof(*e));
+				e->value = counter++;
+			}
+
+			if (!darr_seq_insert_view(s, i, darr_view_all(batch))
+				|| !darr_insert(expected, i, batch)) {
+				fprintf(stderr, "Failed to insert.\n");
+				return 0;
+			}
+		} else if (size > 0) {
+			size_t start = next_random(&state) % size;
+
+			if (count > size - start) {
+				count = size - start;
+			}
+
+			darr_seq_remove(s, start, count);
+			darr_remove(expected, start, count);
+		}
+
+		if (op % 100 == 0 && !same(s, expected, flat)) {
+			fprintf(stderr, "The sequence differs after %d operations.\n",
+				op);
+			return 0;
+		}
+	}
+
+	if (!same(s, expected, flat)) {
+		fprintf(stderr, "The sequence differs at the end.\n");
+		return 0;
+	}
+
+	// Slices and removing everything.
+	size_t size = darr_seq_size(s);
+
+	if (size > 100) {
+		if (!darr_seq_slice(flat, s, 50, size - 100)
+			|| darr_size(flat) != size - 100
+			|| memcmp(darr_data(flat), darr_element(expected, 50),
+				(size - 100) * sizeof(struct element)) != 0) {
+			fprintf(stderr, "Wrong slice.\n");
+			return 0;
+		}
+	}
+
+	darr_seq_remove(s, 0, size);
+
+	if (darr_seq_size(s) != 0) {
+		fprintf(stderr, "Failed to remove all elements.\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	struct darr_seq s;
+	darr_seq_init(&s, sizeof(struct element));
+
+	struct darr expected;
+	struct darr batch;
+	struct darr flat;
+	darr_init(&expected, sizeof(struct element));
+	darr_init(&batch, sizeof(struct element));
+	darr_init(&flat, sizeof(struct element));
+
+	int result = check(&s, &expected, &batch, &flat);
+
+	darr_seq_deinit(&s);
+	darr_deinit(&expected);
+	darr_deinit(&batch);
+	darr_deinit(&flat);
+
+	return result ? 0 : 1;
+}
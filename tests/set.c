@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../src/darr_set.h"
+
+#define RANGE 5000
+
+static void push(struct darr *array, const void *e)
+{
+	darr_grow(array, 1);
+	memcpy(darr_last(array), e, array->element_size);
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+	*state = *state * 1664525 + 1013904223;
+	return *state >> 8;
+}
+
+/*
+ * Fills the array with the values below RANGE for which in is set, in
+ * ascending order.
+ */
+static void fill(struct darr *array, const char *in)
+{
+	darr_resize(array, 0);
+
+	for (uint64_t v = 0; v < RANGE; ++v) {
+		if (!in[v]) {
+			continue;
+		}
+
+		if (array->element_size == 4) {
+			uint32_t e = (uint32_t) v;
+			push(array, &e);
+		} else {
+			uint64_t e = v;
+			push(array, &e);
+		}
+	}
+}
+
+/*
+ * Checks that the array holds exactly the values below RANGE for which
+ * expected is set, in ascending order.
+ */
+static int equals(struct darr *array, const char *expected)
+{
+	struct darr other;
+	darr_init(&other, array->element_size);
+	fill(&other, expected);
+
+	int result = darr_size(array) == darr_size(&other)
+		&& (darr_size(array) == 0
+			|| memcmp(darr_data(array), darr_data(&other),
+				darr_size(array) * array->element_size) == 0);
+
+	darr_deinit(&other);
+	return result;
+}
+
+/*
+ * Picks values for two sets where one has about ratio times as many values
+ * as the other and checks all three operations against the expected result.
+ */
+static int check(size_t element_size, uint32_t ratio, uint32_t seed)
+{
+	static char in_a[RANGE];
+	static char in_b[RANGE];
+	static char expected[RANGE];
+
+	for (size_t v = 0; v < RANGE; ++v) {
+		in_a[v] = next_random(&seed) % ratio == 0;
+		in_b[v] = next_random(&seed) % 2 == 0;
+	}
+
+	struct darr a, b, out;
+	darr_init(&a, element_size);
+	darr_init(&b, element_size);
+	darr_init(&out, element_size);
+	fill(&a, in_a);
+	fill(&b, in_b);
+
+	int result = 1;
+
+	for (size_t v = 0; v < RANGE; ++v) {
+		expected[v] = in_a[v] || in_b[v];
+	}
+
+	result = result
+		&& darr_set_union(&out, &a, &b, NULL)
+		&& equals(&out, expected);
+
+	for (size_t v = 0; v < RANGE; ++v) {
+		expected[v] = in_a[v] && in_b[v];
+	}
+
+	result = result
+		&& darr_set_intersection(&out, &a, &b, NULL)
+		&& equals(&out, expected)
+		&& darr_set_intersection(&out, &b, &a, NULL)
+		&& equals(&out, expected);
+
+	for (size_t v = 0; v < RANGE; ++v) {
+		expected[v] = in_a[v] && !in_b[v];
+	}
+
+	result = result
+		&& darr_set_difference(&out, &a, &b, NULL)
+		&& equals(&out, expected);
+
+	for (size_t v = 0; v < RANGE; ++v) {
+		expected[v] = in_b[v] && !in_a[v];
+	}
+
+	result = result
+		&& darr_set_difference(&out, &b, &a, NULL)
+		&& equals(&out, expected);
+
+	darr_deinit(&a);
+	darr_deinit(&b);
+	darr_deinit(&out);
+	return result;
+}
+
+/*
+ * Combines an empty array, which has no buffer, with one that is not.
+ */
+static int check_empty(void)
+{
+	struct darr empty, other, out;
+	darr_init(&empty, sizeof(uint32_t));
+	darr_init(&other, sizeof(uint32_t));
+	darr_init(&out, sizeof(uint32_t));
+
+	uint32_t value = 7;
+	push(&other, &value);
+
+	int result = darr_set_union(&out, &empty, &other, NULL)
+		&& darr_size(&out) == 1
+		&& darr_set_union(&out, &other, &empty, NULL)
+		&& darr_size(&out) == 1
+		&& darr_set_union(&out, &empty, &empty, NULL)
+		&& darr_size(&out) == 0
+		&& darr_set_difference(&out, &empty, &other, NULL)
+		&& darr_size(&out) == 0
+		&& darr_set_difference(&out, &other, &empty, NULL)
+		&& darr_size(&out) == 1;
+
+	darr_deinit(&empty);
+	darr_deinit(&other);
+	darr_deinit(&out);
+	return result;
+}
+
+struct entry {
+	int key;
+	int value;
+};
+
+static int compare_descending(const void *a, const void *b)
+{
+	const struct entry *x = a;
+	const struct entry *y = b;
+	return (x->key < y->key) - (x->key > y->key);
+}
+
+int main(void)
+{
+	// Comparable sizes and sizes far enough apart for galloping.
+	uint32_t ratios[] = { 1, 2, 3, 100, 1000 };
+
+	for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); ++r) {
+		if (!check(4, ratios[r], r) || !check(8, ratios[r], r)) {
+			fprintf(stderr, "Wrong result with a ratio of %u.\n", ratios[r]);
+			return 1;
+		}
+	}
+
+	if (!check_empty()) {
+		fprintf(stderr, "Wrong result with an empty array.\n");
+		return 1;
+	}
+
+	struct darr a, b, out;
+	darr_init(&a, sizeof(struct entry));
+	darr_init(&b, sizeof(struct entry));
+	darr_init(&out, sizeof(struct entry));
+
+	struct entry ea[] = { { 9, 1 }, { 7, 1 }, { 7, 2 }, { 4, 1 }, { 4, 2 } };
+	struct entry eb[] = { { 8, 3 }, { 7, 3 }, { 1, 3 } };
+
+	for (size_t i = 0; i < 5; ++i) {
+		push(&a, &ea[i]);
+	}
+
+	for (size_t i = 0; i < 3; ++i) {
+		push(&b, &eb[i]);
+	}
+
+	if (!darr_unique(&a, compare_descending)
+		|| darr_size(&a) != 3
+		|| ((struct entry *) darr_element(&a, 1))->value != 1
+		|| ((struct entry *) darr_element(&a, 2))->key != 4) {
+		fprintf(stderr, "darr_unique did not keep the first elements.\n");
+		return 1;
+	}
+
+	if (!darr_set_union(&out, &a, &b, compare_descending)
+		|| darr_size(&out) != 5
+		|| ((struct entry *) darr_element(&out, 1))->key != 8
+		|| ((struct entry *) darr_element(&out, 2))->value != 1
+		|| ((struct entry *) darr_element(&out, 4))->key != 1) {
+		fprintf(stderr, "Wrong union with a comparison function.\n");
+		return 1;
+	}
+
+	if (!darr_set_intersection(&out, &b, &a, compare_descending)
+		|| darr_size(&out) != 1
+		|| ((struct entry *) darr_element(&out, 0))->value != 3) {
+		fprintf(stderr, "Wrong intersection with a comparison function.\n");
+		return 1;
+	}
+
+	if (!darr_set_difference(&out, &a, &b, compare_descending)
+		|| darr_size(&out) != 2
+		|| ((struct entry *) darr_element(&out, 0))->key != 9
+		|| ((struct entry *) darr_element(&out, 1))->key != 4) {
+		fprintf(stderr, "Wrong difference with a comparison function.\n");
+		return 1;
+	}
+
+	darr_deinit(&a);
+	darr_deinit(&b);
+
+	darr_init(&a, sizeof(uint16_t));
+	uint16_t values[] = { 1, 1, 1, 2, 3, 3, 500, 500 };
+
+	for (size_t i = 0; i < 8; ++i) {
+		push(&a, &values[i]);
+	}
+
+	if (!darr_unique(&a, NULL)
+		|| darr_size(&a) != 4
+		|| *(uint16_t *) darr_last(&a) != 500) {
+		fprintf(stderr, "darr_unique did not remove duplicates.\n");
+		return 1;
+	}
+
+	darr_deinit(&a);
+	darr_deinit(&out);
+
+	// Elements of 3 bytes have no order without a comparison function.
+	darr_init(&a, 3);
+	darr_init(&out, 3);
+	push(&a, "ab");
+
+	if (darr_unique(&a, NULL)
+		|| darr_set_union(&out, &a, &a, NULL)
+		|| darr_set_intersection(&out, &a, &a, NULL)
+		|| darr_set_difference(&out, &a, &a, NULL)) {
+		fprintf(stderr, "Compared elements of 3 bytes without a function.\n");
+		darr_deinit(&a);
+		darr_deinit(&out);
+		return 1;
+	}
+
+	darr_deinit(&a);
+	darr_deinit(&out);
+
+	return 0;
+}
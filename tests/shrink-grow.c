@@ -2,6 +2,13 @@
 
 #include "../src/darr.h"
 
+static void *failing_realloc(void *p, size_t size)
+{
+	(void) p;
+	(void) size;
+	return NULL;
+}
+
 int main(void)
 {
 	struct darr array;
@@ -25,6 +32,28 @@ int main(void)
 		return 1;
 	}
 
+	// Truncating keeps the buffer when it cannot be shrunk.
+	darr_resize(&array, 100);
+	void *data = darr_data(&array);
+	darr_global_realloc_set(failing_realloc);
+	darr_truncate(&array, 10);
+	darr_global_realloc_set(realloc);
+	darr_global_calloc_set(calloc);
+
+	if (darr_size(&array) != 10 || darr_data(&array) != data) {
+		fprintf(stderr, "Failed to truncate.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_truncate(&array, 0);
+
+	if (darr_size(&array) != 0) {
+		fprintf(stderr, "Failed to truncate to zero.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
 	darr_deinit(&array);
 	return 0;
 }
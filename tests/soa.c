@@ -0,0 +1,89 @@
+#include <stdio.h>
+
+#include "../src/darr_soa.h"
+
+/*
+ * Fails large requests so that only the column of doubles fails to grow.
+ */
+static void *limited_realloc(void *p, size_t size)
+{
+	return size > 6000 ? NULL : realloc(p, size);
+}
+
+int main(void)
+{
+	size_t sizes[] = { sizeof(int), sizeof(double) };
+
+	struct darr_soa soa;
+	darr_soa_init(&soa, 2, sizes);
+
+	for (int i = 0; i < 5; ++i) {
+		double d = i * 0.5;
+		const void *values[] = { &i, &d };
+
+		if (!darr_soa_push(&soa, values)) {
+			fprintf(stderr, "Failed to push record %d.\n", i);
+			darr_soa_deinit(&soa);
+			return 1;
+		}
+	}
+
+	if (darr_soa_size(&soa) != 5) {
+		fprintf(stderr, "Wrong number of records.\n");
+		darr_soa_deinit(&soa);
+		return 1;
+	}
+
+	int *ids = darr_soa_column(&soa, 0);
+	double *values = darr_soa_column(&soa, 1);
+
+	for (int i = 0; i < 5; ++i) {
+		if (ids[i] != i || values[i] != i * 0.5) {
+			fprintf(stderr, "Record %d does not have the expected fields.\n", i);
+			darr_soa_deinit(&soa);
+			return 1;
+		}
+	}
+
+	// Records: 0 1 2 3 4 -> 0 4 2 3
+	darr_soa_swap_remove(&soa, 1);
+	// Records: 0 4 2 3 -> 0 3
+	darr_soa_remove(&soa, 1, 2);
+
+	ids = darr_soa_column(&soa, 0);
+	values = darr_soa_column(&soa, 1);
+
+	if (darr_soa_size(&soa) != 2 || ids[1] != 3 || values[1] != 1.5) {
+		fprintf(stderr, "Columns were not kept in lockstep.\n");
+		darr_soa_deinit(&soa);
+		return 1;
+	}
+
+	if (darr_view_size(darr_soa_column_view(&soa, 1)) != 2) {
+		fprintf(stderr, "Column view has the wrong size.\n");
+		darr_soa_deinit(&soa);
+		return 1;
+	}
+
+	// The first column grows and the second one does not.
+	darr_global_realloc_set(limited_realloc);
+	int grew = darr_soa_resize(&soa, 1000);
+	darr_global_realloc_set(realloc);
+	darr_global_calloc_set(calloc);
+
+	ids = darr_soa_column(&soa, 0);
+	values = darr_soa_column(&soa, 1);
+
+	if (grew
+		|| darr_soa_size(&soa) != 2
+		|| darr_size(darr_soa_darr(&soa, 0)) != 2
+		|| ids[1] != 3
+		|| values[1] != 1.5) {
+		fprintf(stderr, "Failed resize changed the columns.\n");
+		darr_soa_deinit(&soa);
+		return 1;
+	}
+
+	darr_soa_deinit(&soa);
+	return 0;
+}
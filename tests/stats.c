@@ -0,0 +1,68 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+int main(void)
+{
+	darr_stats_reset(darr_stats_global_get());
+
+	struct darr array;
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 4);
+
+	const struct darr_stats *stats = darr_stats_get(&array);
+
+	if (stats->reallocs != 1) {
+		fprintf(stderr, "Resize was not counted as a realloc.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	if (stats->bytes_allocated != 4 * sizeof(int)) {
+		fprintf(stderr, "Wrong number of bytes allocated.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	darr_shift_right(&array, 1);
+
+	if (stats->memmoves[DARR_STATS_OP_SHIFT] != 1
+		|| stats->bytes_memmoved[DARR_STATS_OP_SHIFT] != 3 * sizeof(int)) {
+		fprintf(stderr, "Shift was not counted as a memmove.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	struct darr array2;
+	darr_copy(&array2, &array);
+
+	if (darr_stats_get(&array2)->memcpys[DARR_STATS_OP_COPY] != 1) {
+		fprintf(stderr, "Copy was not counted as a memcpy.\n");
+		darr_deinit(&array);
+		darr_deinit(&array2);
+		return 1;
+	}
+
+	darr_append(&array, &array2);
+
+	if (stats->bytes_memcpyed[DARR_STATS_OP_APPEND] != 4 * sizeof(int)) {
+		fprintf(stderr, "Append was not counted as a memcpy.\n");
+		darr_deinit(&array);
+		darr_deinit(&array2);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_deinit(&array2);
+
+	const struct darr_stats *global = darr_stats_global_get();
+
+	if (global->reallocs != 3 || global->frees != 2) {
+		fprintf(stderr, "Global counters do not add up.\n");
+		return 1;
+	}
+
+	darr_stats_dump(stdout, global);
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+
+#include "../src/darr.h"
+
+int main(void)
+{
+	struct darr array;
+	darr_init(&array, sizeof(int));
+	darr_resize(&array, 4);
+
+	int *element = darr_element(&array, 0);
+
+	element[0] = 0;
+	element[1] = 1;
+	element[2] = 2;
+	element[3] = 3;
+
+	struct darr_view view = darr_view_slice(&array, 1, 2);
+
+	if (darr_view_size(view) != 2) {
+		fprintf(stderr, "Wrong size for view.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	if (darr_view_data(view) != darr_element(&array, 1)) {
+		fprintf(stderr, "View does not point into the array.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	const int *viewed = darr_view_element(view, 1);
+
+	if (*viewed != 2) {
+		fprintf(stderr, "Wrong value for second element of view.\n");
+		darr_deinit(&array);
+		return 1;
+	}
+
+	struct darr array2;
+	darr_init(&array2, sizeof(int));
+
+	darr_append_view(&array2, view);
+	darr_prepend_view(&array2, darr_view_slice(&array, 0, 1));
+	darr_insert_view(&array2, 3, darr_view_slice(&array, 3, 1));
+
+	if (darr_size(&array2) != 4) {
+		fprintf(stderr, "Wrong size after inserting views.\n");
+		darr_deinit(&array);
+		darr_deinit(&array2);
+		return 1;
+	}
+
+	int *element2 = darr_element(&array2, 0);
+
+	for (int i = 0; i < 4; ++i) {
+		if (element2[i] != i) {
+			fprintf(stderr, "Element %d does not have the expected value.\n", i);
+			darr_deinit(&array);
+			darr_deinit(&array2);
+			return 1;
+		}
+	}
+
+	struct darr array3;
+	darr_copy_view(&array3, darr_view_slice(&array2, 2, 2));
+
+	if (darr_size(&array3) != 2 || *(int *) darr_first(&array3) != 2) {
+		fprintf(stderr, "Copy of view does not have the expected elements.\n");
+		darr_deinit(&array);
+		darr_deinit(&array2);
+		darr_deinit(&array3);
+		return 1;
+	}
+
+	darr_deinit(&array);
+	darr_deinit(&array2);
+	darr_deinit(&array3);
+	return 0;
+}